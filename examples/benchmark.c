@@ -0,0 +1,75 @@
+#define _POSIX_C_SOURCE 199309L // for clock_gettime
+
+#include "exceptional.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 1000000
+
+static double now() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static void report(const char *name, double start, long iterations) {
+	printf("  %-24s %8.1f ns\n", name, (now() - start) / iterations);
+}
+
+static void fail WITH_EXCEPTIONS (int depth) {
+	if (depth == 0)
+		throw(Value, "oops");
+	else
+		fail CALL_WITH_EXCEPTIONS (depth - 1);
+}
+
+int main(int argc, char *argv[]) {
+	long iterations = argc > 1 ? atol(argv[1]) : DEFAULT_ITERATIONS;
+	volatile long counter = 0;
+
+	printf(ANSI_COLOR_BRIGHT_GREEN "Jump backend: %s (%ld iterations)\n" ANSI_COLOR_RESET, EXCEPTIONAL_JUMP_BACKEND, iterations);
+
+	with_exceptions (local) {
+		// Entering and leaving a "try" that doesn't throw
+		double start = now();
+		for (long i = 0; i < iterations; i++) {
+			try counter++;
+			finally counter++;
+		}
+		report("try/finally", start, iterations);
+
+		// Entering and leaving a scope that is never used
+		start = now();
+		for (long i = 0; i < iterations; i++) {
+			with_exceptions (local) counter++;
+		}
+		report("with_exceptions", start, iterations);
+
+		// Throwing into a "catch" in the same function
+		start = now();
+		for (long i = 0; i < iterations; i++) {
+			try throw(Value, "oops");
+			finally catch (Value, e) counter++;
+		}
+		report("throw/catch", start, iterations);
+
+		// Throwing a formatted message that is never read
+		start = now();
+		for (long i = 0; i < iterations; i++) {
+			try throwf(Value, "bad field %s at %d", "name", (int) i);
+			finally catch (Value, e) counter++;
+		}
+		report("throwf/catch", start, iterations);
+
+		// Throwing into a "catch" through a few calls
+		start = now();
+		for (long i = 0; i < iterations; i++) {
+			try fail CALL_WITH_EXCEPTIONS (8);
+			finally catch (Value, e) counter++;
+		}
+		report("throw/catch (depth 8)", start, iterations);
+	}
+
+	return 0;
+}
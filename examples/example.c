@@ -8,6 +8,28 @@ static void test WITH_EXCEPTIONS (const char *text) {
 	throwf(Exception, "our text is \"%s\"", text);
 }
 
+static long sum WITH_EXCEPTIONS (int from, int to) {
+	if (to - from <= 10) {
+		if ((from <= 42) && (42 < to))
+			throwf(Value, "oops 10 in tasks %d to %d", from, to);
+		return (long) (to - from) * (from + to - 1) / 2;
+	}
+	long left, right;
+	taskgroup_with_exceptions {
+		#pragma omp task shared(left)
+		{
+			capture_exceptions
+				left = sum CALL_WITH_EXCEPTIONS (from, (from + to) / 2);
+		}
+		#pragma omp task shared(right)
+		{
+			capture_exceptions
+				right = sum CALL_WITH_EXCEPTIONS ((from + to) / 2, to);
+		}
+	}
+	return left + right;
+}
+
 static void *mythread1(void *data) {
 	with_exceptions (posix) {
 		try
@@ -22,8 +44,6 @@ static void *mythread1(void *data) {
 }
 
 static void *mythread2(void *data) {
-	initialize_exceptions(openmp);
-
 	with_exceptions (posix) {
 		try {
 			with_exceptions_relay (openmp) {
@@ -44,8 +64,6 @@ static void *mythread2(void *data) {
 		}
 	}
 
-	shutdown_exceptions(openmp);
-
 	return NULL;
 }
 
@@ -71,6 +89,12 @@ int main(int argc, char *argv[]) {
 		finally catch (Exception, e)
 			Exception_dump(e, stdout, EXCEPTION_DUMP_NESTED);
 
+		printf(ANSI_COLOR_BRIGHT_GREEN "A throw without a message:\n" ANSI_COLOR_RESET);
+		try
+			throwd(Value, NULL);
+		finally catch (Value, e)
+			Exception_dump(e, stdout, EXCEPTION_DUMP_SHORT);
+
 		printf(ANSI_COLOR_BRIGHT_GREEN "Calling a decorated function:\n" ANSI_COLOR_RESET);
 		try
 			test CALL_WITH_EXCEPTIONS ("oops 2");
@@ -140,6 +164,75 @@ int main(int argc, char *argv[]) {
 		}
 		finally catch (Exception, e)
 			Exception_dump(e, stdout, EXCEPTION_DUMP_NESTED);
+
+		printf(ANSI_COLOR_BRIGHT_GREEN "Recursive tasks:\n" ANSI_COLOR_RESET);
+		try {
+			#pragma omp parallel
+			#pragma omp single
+			{
+				capture_exceptions
+					printf("sum is %ld\n", sum CALL_WITH_EXCEPTIONS (0, 100));
+			}
+			throw_captured();
+		}
+		finally catch (Exception, e)
+			Exception_dump(e, stdout, EXCEPTION_DUMP_NESTED);
+
+		printf(ANSI_COLOR_BRIGHT_GREEN "Cancelling a loop:\n" ANSI_COLOR_RESET);
+		try {
+			int done = 0;
+			#pragma omp parallel
+			#pragma omp for
+			for (int i = 0; i < 1000; i++) {
+				capture_exceptions_or_cancel {
+					if (i == 10)
+						throwf(Value, "oops 11 in loop %d", i);
+					#pragma omp atomic
+					done++;
+				}
+			}
+			printf("%d of 1000 loops were done\n", done);
+			throw_captured();
+		}
+		finally catch (Exception, e)
+			Exception_dump(e, stdout, EXCEPTION_DUMP_NESTED);
+
+		printf(ANSI_COLOR_BRIGHT_GREEN "Nested teams, each catching its own exceptions:\n" ANSI_COLOR_RESET);
+		omp_set_max_active_levels(2);
+		#pragma omp parallel num_threads(2)
+		{
+			int outer = omp_get_thread_num();
+			with_exceptions (openmp) {
+				try {
+					#pragma omp parallel for num_threads(2)
+					for (int i = 0; i < 2; i++) {
+						capture_exceptions
+							if (i == outer)
+								throwf(Value, "oops 12 in inner loop %d of outer thread %d", i, outer);
+					}
+					throw_captured();
+				}
+				finally catch (Exception, e) {
+					pthread_mutex_lock(&dump_mutex);
+					Exception_dump(e, stdout, EXCEPTION_DUMP_NESTED);
+					pthread_mutex_unlock(&dump_mutex);
+				}
+			}
+		}
+
+		printf(ANSI_COLOR_BRIGHT_GREEN "Aggregating a failing loop:\n" ANSI_COLOR_RESET);
+		try {
+			aggregate_captured_exceptions(false);
+			#pragma omp parallel for
+			for (int i = 0; i < 1000; i++) {
+				capture_exceptions_for(i)
+					if (i % 3 == 0)
+						throwf(Value, "oops 13 in loop %d", i);
+			}
+			throw_captured();
+		}
+		finally catch (Exception, e)
+			Exception_dump(e, stdout, EXCEPTION_DUMP_NESTED);
 	}
 
 	printf("\n");
@@ -3,21 +3,36 @@
 
 // See README.md for a detailed guide
 
-#include "simclist.h"
 #include "bstrlib.h"
 #include <setjmp.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+// Branch hints, and a marker for functions only called when throwing or debugging
+#define EXCEPTIONAL_LIKELY(X)   __builtin_expect(!!(X), 1)
+#define EXCEPTIONAL_UNLIKELY(X) __builtin_expect(!!(X), 0)
+#define EXCEPTIONAL_COLD        __attribute__((cold))
+
 /*
  * Set to a stream (for example: stdout, stderr) in order to dump debug information.
+ *
+ * Define EXCEPTIONAL_NO_DEBUG to compile out all checks of this stream, in which case it
+ * is ignored.
  */
 extern FILE *exceptional_debug;
 
+#ifdef EXCEPTIONAL_NO_DEBUG
+#define EXCEPTIONAL_DEBUGGING false
+#else
+#define EXCEPTIONAL_DEBUGGING EXCEPTIONAL_UNLIKELY(exceptional_debug)
+#endif
+
 //
 // Keywords
 //
@@ -29,14 +44,15 @@ extern FILE *exceptional_debug;
  *
  * Uncaught exceptions will not be accessible after the block finishes execution.
  *
- * Possible contexts: "local", "global", "posix", "sdl", "openmp"
+ * Possible contexts: "local", "global", "tls", "posix", "sdl", "openmp"
  */
 #define with_exceptions(CONTEXT) \
 	/* Create scope. */ \
 	ExceptionScope_##CONTEXT EXCEPTIONAL_LOCAL(scope) = ExceptionScope_##CONTEXT##_new(); \
 	/* Execute the code block with "current_execution_scope", and then destroy it. */ \
 	for (ExceptionScope *current_exception_scope = (ExceptionScope *) &EXCEPTIONAL_LOCAL(scope); !current_exception_scope->done; current_exception_scope->done = true, \
-		ExceptionScope_destroy(current_exception_scope))
+		ExceptionScope_destroy(current_exception_scope)) \
+		EXCEPTIONAL_BIND_GET(CONTEXT)
 
 /*
  * Declares a code block with local variable scope.
@@ -45,20 +61,22 @@ extern FILE *exceptional_debug;
  *
  * Can only be used inside a "with_exceptions" code block or a function decorated with "WITH_EXCEPTIONS".
  *
- * Possible contexts: "local", "global", "posix", "sdl", "openmp"
+ * Possible contexts: "local", "global", "tls", "posix", "sdl", "openmp"
  */
 #define with_exceptions_relay(CONTEXT) \
 	/* Create scopes. */ \
 	ExceptionScope_##CONTEXT EXCEPTIONAL_LOCAL(scope) = ExceptionScope_##CONTEXT##_new(); \
 	ExceptionScope *EXCEPTIONAL_LOCAL(relay_scope) = current_exception_scope; \
+	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = ExceptionScope_##CONTEXT##_get_context(&EXCEPTIONAL_LOCAL(scope)); \
 	/* Create a jump point. */ \
-	jmp_buf EXCEPTIONAL_LOCAL(jmp); \
-	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = setjmp(EXCEPTIONAL_LOCAL(jmp)); \
+	EXCEPTIONAL_DECLARE_FRAME \
+	ExceptionJumpBuffer EXCEPTIONAL_LOCAL(jmp); \
+	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = EXCEPTIONAL_SETJMP(EXCEPTIONAL_LOCAL(exception_context), EXCEPTIONAL_LOCAL(jmp)); \
 	/* Execute the code block, relay uncaught exceptions, and then jump to last jump point in the relay context. */ \
-	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = ((ExceptionScope *) &EXCEPTIONAL_LOCAL(scope))->get(&EXCEPTIONAL_LOCAL(scope)); \
-	if (ExceptionScope_with_exceptions_relay((ExceptionScope *) &EXCEPTIONAL_LOCAL(scope), EXCEPTIONAL_LOCAL(relay_scope), &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), "with_exceptions_relay", __FILE__, __LINE__, __FUNCTION__)) \
+	if (ExceptionScope_with_exceptions_relay((ExceptionScope *) &EXCEPTIONAL_LOCAL(scope), EXCEPTIONAL_LOCAL(relay_scope), EXCEPTIONAL_FRAME, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), "with_exceptions_relay", __FILE__, __LINE__, __FUNCTION__)) \
 		for (ExceptionScope *current_exception_scope = (ExceptionScope *) &EXCEPTIONAL_LOCAL(scope); !current_exception_scope->done; current_exception_scope->done = true, \
-			ExceptionScope_with_exceptions_relay_done(current_exception_scope, EXCEPTIONAL_LOCAL(relay_scope)))
+			ExceptionScope_with_exceptions_relay_done(current_exception_scope, EXCEPTIONAL_LOCAL(relay_scope))) \
+			EXCEPTIONAL_BIND_GET(CONTEXT)
 
 /*
  * Like "with_exceptions", but after execution relays all uncaught exceptions to a specified context.
@@ -66,21 +84,23 @@ extern FILE *exceptional_debug;
  * This is the same as, but more efficient than, using "with_exceptions (RELAYCONTEXT)" with a
  * "with_exceptions_relay (CONTEXT)" inside.
  *
- * Possible contexts:       "local", "global", "posix", "sdl", "openmp"
- * Possible relay contexts: "global", "posix", "sdl", "openmp"
+ * Possible contexts:       "local", "global", "tls", "posix", "sdl", "openmp"
+ * Possible relay contexts: "global", "tls", "posix", "sdl", "openmp"
  */
 #define with_exceptions_relay_to(CONTEXT, RELAYCONTEXT) \
 	/* Create scopes. */ \
 	ExceptionScope_##CONTEXT EXCEPTIONAL_LOCAL(scope) = ExceptionScope_##CONTEXT##_new(); \
 	ExceptionScope_##RELAYCONTEXT EXCEPTIONAL_LOCAL(relay_scope) = ExceptionScope_##RELAYCONTEXT##_new(); \
+	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = ExceptionScope_##CONTEXT##_get_context(&EXCEPTIONAL_LOCAL(scope)); \
 	/* Create a jump point. */ \
-	jmp_buf EXCEPTIONAL_LOCAL(jmp); \
-	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = setjmp(EXCEPTIONAL_LOCAL(jmp)); \
+	EXCEPTIONAL_DECLARE_FRAME \
+	ExceptionJumpBuffer EXCEPTIONAL_LOCAL(jmp); \
+	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = EXCEPTIONAL_SETJMP(EXCEPTIONAL_LOCAL(exception_context), EXCEPTIONAL_LOCAL(jmp)); \
 	/* Execute the code block, relay uncaught exceptions, and then jump to last jump point in the relay context. */ \
-	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = ((ExceptionScope *) &EXCEPTIONAL_LOCAL(scope))->get(&EXCEPTIONAL_LOCAL(scope)); \
-	if (ExceptionScope_with_exceptions_relay((ExceptionScope *) &EXCEPTIONAL_LOCAL(scope), (ExceptionScope *) &EXCEPTIONAL_LOCAL(relay_scope), &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), "with_exceptions_relay_to", __FILE__, __LINE__, __FUNCTION__)) \
+	if (ExceptionScope_with_exceptions_relay_to((ExceptionScope *) &EXCEPTIONAL_LOCAL(scope), (ExceptionScope *) &EXCEPTIONAL_LOCAL(relay_scope), EXCEPTIONAL_FRAME, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), "with_exceptions_relay_to", __FILE__, __LINE__, __FUNCTION__)) \
 		for (ExceptionScope *current_exception_scope = (ExceptionScope *) &EXCEPTIONAL_LOCAL(scope); !current_exception_scope->done; current_exception_scope->done = true, \
-			ExceptionScope_with_exceptions_relay_done(current_exception_scope, (ExceptionScope *) &EXCEPTIONAL_LOCAL(relay_scope)))
+			ExceptionScope_with_exceptions_relay_to_done(current_exception_scope, (ExceptionScope *) &EXCEPTIONAL_LOCAL(relay_scope))) \
+			EXCEPTIONAL_BIND_GET(CONTEXT)
 
 /*
  * Declares a code block with local variable scope.
@@ -92,14 +112,15 @@ extern FILE *exceptional_debug;
  * Can only be used inside a "with_exceptions" code block or a function decorated with "WITH_EXCEPTIONS".
  */
 #define try \
+	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = get_current_exception_context(); \
 	/* Create a jump point. */ \
-	jmp_buf EXCEPTIONAL_LOCAL(jmp); \
-	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = setjmp(EXCEPTIONAL_LOCAL(jmp)); \
+	EXCEPTIONAL_DECLARE_FRAME \
+	ExceptionJumpBuffer EXCEPTIONAL_LOCAL(jmp); \
+	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = EXCEPTIONAL_SETJMP(EXCEPTIONAL_LOCAL(exception_context), EXCEPTIONAL_LOCAL(jmp)); \
 	/* Execute the code block. */ \
 	/* If an exception is thrown, we will switch to unwinding mode. */ \
 	/* If the exception is caught by a "catch", unwinding mode will be disabled. */ \
-	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = get_current_exception_context(); \
-	for (ExceptionContext_try(EXCEPTIONAL_LOCAL(exception_context), &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), __FILE__, __LINE__, __FUNCTION__); ExceptionContext_is_trying(EXCEPTIONAL_LOCAL(exception_context)); ExceptionContext_stop_trying(EXCEPTIONAL_LOCAL(exception_context)))
+	for (ExceptionContext_try(EXCEPTIONAL_LOCAL(exception_context), EXCEPTIONAL_FRAME, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), __FILE__, __LINE__, __FUNCTION__); ExceptionContext_is_trying(EXCEPTIONAL_LOCAL(exception_context)); ExceptionContext_stop_trying(EXCEPTIONAL_LOCAL(exception_context)))
 
 /*
  * Declares a code block with local variable scope.
@@ -128,6 +149,30 @@ extern FILE *exceptional_debug;
 		ExceptionContext_catch_done(get_current_exception_context(), VAR), \
 		VAR = NULL)
 
+/*
+ * Like several "catch" code blocks, but selects among them in one pass. The code block
+ * is the body of a "switch" on the index of the matched type (0 for the first).
+ *
+ * The first thrown exception that matches any of the types is caught, and the most
+ * specific of the types it matches is selected, regardless of their order. Supports up
+ * to 16 types.
+ *
+ * Can only be used inside a "finally" code block. For example:
+ *
+ * finally catch_any_of (e, FileNotFound, IO, Value) {
+ *   case 0: ... break; // FileNotFound
+ *   case 1: ... break; // IO (but not FileNotFound)
+ *   case 2: ... break; // Value
+ * }
+ */
+#define catch_any_of(VAR, ...) \
+	for (int EXCEPTIONAL_LOCAL(index) = -1; EXCEPTIONAL_LOCAL(index) == -1; EXCEPTIONAL_LOCAL(index) = -2) \
+		for (Exception *VAR = ExceptionContext_catch_any(get_current_exception_context(), \
+			(const ExceptionType *[]) { EXCEPTIONAL_TYPES(__VA_ARGS__), NULL }, &EXCEPTIONAL_LOCAL(index)); VAR; \
+			ExceptionContext_catch_done(get_current_exception_context(), VAR), \
+			VAR = NULL) \
+			switch (EXCEPTIONAL_LOCAL(index))
+
 /*
  * Executes a code block with local variable scope.
  *
@@ -136,13 +181,64 @@ extern FILE *exceptional_debug;
  * Can only be used inside a "with_exceptions" code block or a function decorated with "WITH_EXCEPTIONS".
  */
 #define capture_exceptions \
+	capture_exceptions_for(0)
+
+/*
+ * Like "capture_exceptions", recording PAYLOAD (a long, typically the loop iteration) with
+ * the captured exceptions if the scope aggregates them (see "aggregate_captured_exceptions").
+ */
+#define capture_exceptions_for(PAYLOAD) \
+	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = get_current_exception_context(); \
+	long EXCEPTIONAL_LOCAL(payload) = (PAYLOAD); \
 	/* Create a jump point. */ \
-	jmp_buf EXCEPTIONAL_LOCAL(jmp); \
-	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = setjmp(EXCEPTIONAL_LOCAL(jmp)); \
+	EXCEPTIONAL_DECLARE_FRAME \
+	ExceptionJumpBuffer EXCEPTIONAL_LOCAL(jmp); \
+	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = EXCEPTIONAL_SETJMP(EXCEPTIONAL_LOCAL(exception_context), EXCEPTIONAL_LOCAL(jmp)); \
 	/*  Executes the code block and then moves all uncaught exceptions to the scope. */ \
-	if (ExceptionScope_capture_exceptions(current_exception_scope, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), __FILE__, __LINE__, __FUNCTION__)) \
+	if (ExceptionScope_capture_exceptions(current_exception_scope, EXCEPTIONAL_LOCAL(payload), EXCEPTIONAL_FRAME, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), __FILE__, __LINE__, __FUNCTION__)) \
 		for (bool done_ = false; !done_; done_ = true, \
-			ExceptionContext_pop_frame(get_current_exception_context()))
+			ExceptionContext_pop_frame(EXCEPTIONAL_LOCAL(exception_context)))
+
+/*
+ * Like "capture_exceptions", for the body of a "#pragma omp for" loop that should fail
+ * fast: the first captured exception cancels the loop, so that the remaining iterations
+ * are skipped.
+ *
+ * If cancellation is enabled in the OpenMP runtime (OMP_CANCELLATION=true) the loop is
+ * cancelled via "#pragma omp cancel for", otherwise every remaining iteration just checks
+ * a flag in the scope and does nothing. Either way, the captured exceptions can then be
+ * thrown by "throw_captured", or relayed at the end of "with_exceptions_relay".
+ *
+ * Use a "#pragma omp for" inside a "#pragma omp parallel": gcc treats the loop of a
+ * combined "#pragma omp parallel for" as "nowait", which can't be cancelled (it warns,
+ * and only the flag is checked). The loop must not be "nowait" or "ordered" either. Can
+ * only be used inside a "with_exceptions" code block.
+ */
+#define capture_exceptions_or_cancel \
+	EXCEPTIONAL_CAPTURE_EXCEPTIONS_OR_CANCEL(for)
+
+/*
+ * Like "capture_exceptions_or_cancel", for the body of a "#pragma omp task" (or a
+ * "taskloop") in a "taskgroup_with_exceptions" code block: the first captured exception
+ * cancels the taskgroup, so that its tasks that haven't started yet are skipped.
+ */
+#define capture_task_exceptions_or_cancel \
+	EXCEPTIONAL_CAPTURE_EXCEPTIONS_OR_CANCEL(taskgroup)
+
+/*
+ * Executes a code block as an OpenMP taskgroup with its own scope. Exceptions captured by
+ * its tasks (and their descendant tasks), which can run on any thread of the team, are
+ * thrown into the containing context after all of them have completed.
+ *
+ * The code block itself must not throw (it would leave the taskgroup while its tasks are
+ * still running): capture in the tasks instead. Nest these code blocks for recursive
+ * tasks, so that every level has its own scope. Tasks must be tied (the default).
+ *
+ * Can only be used inside a "with_exceptions" code block.
+ */
+#define taskgroup_with_exceptions \
+	with_exceptions_relay (openmp) \
+		EXCEPTIONAL_OMP_PRAGMA(omp taskgroup)
 
 //
 // API
@@ -175,8 +271,6 @@ extern FILE *exceptional_debug;
 
 /*
  * Like "throwd", with printf-style formatting.
- *
- * The resulting message is limited in size to EXCEPTIONAL_MAX_MESSAGE_SIZE.
  */
 #define throwf(TYPE, FORMAT, ...) \
 	/* Add an exception and then jump to the previous jump point on the stack. */ \
@@ -229,6 +323,20 @@ extern FILE *exceptional_debug;
 #define uncapture_exceptions() \
 		ExceptionScope_uncapture_exceptions(current_exception_scope)
 
+/*
+ * From now on, exceptions captured in the current scope are aggregated: those of the same
+ * type thrown at the same place (and, if BY_MESSAGE is true, with the same message) are
+ * collapsed into the first of them, which keeps their count and the first and last few
+ * payloads given to "capture_exceptions_for" (see "Exception_get_count" and
+ * "Exception_get_payloads"). Memory then grows with the kinds of failures rather than
+ * their number.
+ *
+ * Call before capturing, outside of the parallel code. Can only be used inside a
+ * "with_exceptions" code block.
+ */
+#define aggregate_captured_exceptions(BY_MESSAGE) \
+	ExceptionScope_aggregate(current_exception_scope, BY_MESSAGE)
+
 /*
  * Throws exceptions captured in a previous "capture_exceptions" code block.
  *
@@ -273,9 +381,12 @@ extern FILE *exceptional_debug;
  * The current ExceptionContext.
  *
  * Can only be used inside a "with_exceptions" code block.
+ *
+ * Inside "with_exceptions" code blocks the context type is known, so the lookup is
+ * inlined, while in "WITH_EXCEPTIONS" functions it goes through the scope's "get".
  */
 #define get_current_exception_context() \
-	(current_exception_scope->get(current_exception_scope))
+	current_exception_scope_get(current_exception_scope)
 
 //
 // Function decorators
@@ -321,20 +432,42 @@ extern FILE *exceptional_debug;
 #define DECLARE_EXCEPTION_TYPE(TYPE) \
 	extern const ExceptionType ExceptionType##TYPE
 
+// The hierarchy is a file-scope compound literal, so it has static storage and the macro
+// remains a single declaration
 #define DEFINE_EXCEPTION_TYPE(TYPE, SUPERTYPE, DESCRIPTION) \
 	const ExceptionType ExceptionType##TYPE = { \
 		.name = #TYPE, \
 		.description = DESCRIPTION, \
-		.super = &ExceptionType##SUPERTYPE \
+		.super = &ExceptionType##SUPERTYPE, \
+		.hierarchy = &(ExceptionTypeHierarchy) { 0 } \
 	}
 
 //
 // ExceptionType
 //
 
+/*
+ * Types nested deeper than this are still supported, but ExceptionType_is_a is slower
+ * for them.
+ */
+#ifndef EXCEPTIONAL_MAX_TYPE_DEPTH
+#define EXCEPTIONAL_MAX_TYPE_DEPTH 16
+#endif
+
+/*
+ * The type's ancestors indexed by their depth (the root type is at depth 0, and the type
+ * itself at "depth"), so that ExceptionType_is_a is a single comparison. Computed on
+ * first use.
+ */
+typedef struct ExceptionTypeHierarchy {
+	int ready; // depth + 1 once computed, or -1 if too deep
+	const struct ExceptionType *ancestors[EXCEPTIONAL_MAX_TYPE_DEPTH];
+} ExceptionTypeHierarchy;
+
 typedef struct ExceptionType {
 	const char *name, *description;
 	const struct ExceptionType *super;
+	ExceptionTypeHierarchy *hierarchy;
 } ExceptionType;
 
 bool ExceptionType_is_a(const ExceptionType *self, const ExceptionType *type);
@@ -385,27 +518,170 @@ typedef struct ExceptionProgramLocation {
 // ExceptionBacktrace
 //
 
+/*
+ * The most frames a backtrace can be captured with. The actual depth is set at runtime
+ * by the backtrace policy.
+ */
 #ifndef EXCEPTION_MAX_BACKTRACE_SIZE
 #define EXCEPTION_MAX_BACKTRACE_SIZE 32
 #endif
 
+/*
+ * Number of hash buckets for interned backtraces. Any number works, though a power of 2
+ * saves a division.
+ */
+#ifndef EXCEPTIONAL_BACKTRACE_STORE_BUCKETS
+#define EXCEPTIONAL_BACKTRACE_STORE_BUCKETS 4096
+#endif
+
+/*
+ * How many exception types can have their own backtrace policy.
+ */
+#ifndef EXCEPTIONAL_MAX_BACKTRACE_POLICIES
+#define EXCEPTIONAL_MAX_BACKTRACE_POLICIES 32
+#endif
+
+/*
+ * Backtraces are interned: identical ones are stored only once and shared by all the
+ * exceptions that have them. They are never freed.
+ */
 typedef struct ExceptionBacktrace {
-	void *frames[EXCEPTION_MAX_BACKTRACE_SIZE];
+	uint64_t hash;
+	struct ExceptionBacktrace *next;
 	int size;
-	int skip;
+	void *frames[];
 } ExceptionBacktrace;
 
-void ExceptionBacktrace_create(ExceptionBacktrace *self);
-void ExceptionBacktrace_dump(ExceptionBacktrace *self, FILE *file);
+const ExceptionBacktrace *ExceptionBacktrace_create(const ExceptionType *type);
+void ExceptionBacktrace_dump(const ExceptionBacktrace *self, FILE *file);
+
+#ifdef EXCEPTIONAL_BACKTRACE
+
+/*
+ * Pre-warms the backtrace engine for the calling thread, so that the first exception
+ * thrown in it doesn't pay for initialization: with glibc's backtrace() that means
+ * loading libgcc_s, and with EXCEPTIONAL_BACKTRACE_FRAME_POINTERS it means looking up
+ * the thread's stack bounds.
+ */
+void ExceptionBacktrace_initialize();
+
+/*
+ * Sets whether exceptions of a type, and of all its subtypes that have no policy of
+ * their own, capture backtraces. Use a NULL type to set the default policy.
+ *
+ * "sample_rate" is 0 for never, 1 for always, or N to capture one in N exceptions.
+ * "max_depth" is the maximum number of frames, where 0 means EXCEPTION_MAX_BACKTRACE_SIZE.
+ *
+ * By default all exceptions capture backtraces at full depth.
+ *
+ * Returns false if there is no more room for policies (see
+ * EXCEPTIONAL_MAX_BACKTRACE_POLICIES).
+ */
+bool ExceptionBacktrace_set_policy(const ExceptionType *type, unsigned int sample_rate, int max_depth);
 
 //
-// Exception
+// ExceptionSymbolizer
+//
+
+/*
+ * Number of slots in the process-wide symbol cache. Each address maps to one slot, and
+ * evicts whatever was there. Any size works, though a power of 2 saves a division.
+ */
+#ifndef EXCEPTIONAL_SYMBOL_CACHE_SIZE
+#define EXCEPTIONAL_SYMBOL_CACHE_SIZE 1024
+#endif
+
+typedef struct ExceptionSymbol {
+	const char *object;   // the executable or shared object
+	const char *function; // NULL if unknown
+	size_t offset;        // from the start of the function, or of the object if the function is unknown
+	const char *file;     // NULL if unknown
+	int line;
+} ExceptionSymbol;
+
+/*
+ * Symbolizes a return address in-process, using the ELF symbol tables and DWARF line
+ * tables of the executable and shared objects. Each object is read once, on first use.
+ * Results are cached, and cache hits don't take any locks.
+ *
+ * Objects are never unloaded from the symbolizer: after a dlclose, addresses that a later
+ * dlopen maps to the same range still resolve to the closed object.
+ *
+ * Returns false if the address isn't in any loaded object.
+ */
+bool ExceptionSymbolizer_symbolize(void *address, ExceptionSymbol *symbol);
+
+/*
+ * Symbolizes all the frames of a backtrace into the symbol cache, so that dumping it (or
+ * other backtraces from the same call sites) later doesn't have to.
+ */
+void ExceptionSymbolizer_preload(const ExceptionBacktrace *backtrace);
+
+#endif
+
+//
+// ExceptionFormat
 //
 
-#ifndef EXCEPTIONAL_MAX_MESSAGE_SIZE
-#define EXCEPTIONAL_MAX_MESSAGE_SIZE 2048
+/*
+ * Messages of "throwd" and "throwf" (including the terminating null) up to this size
+ * are stored inside the exception itself. Longer ones take a single allocation.
+ */
+#ifndef EXCEPTIONAL_INLINE_MESSAGE_SIZE
+#define EXCEPTIONAL_INLINE_MESSAGE_SIZE 64
 #endif
 
+/*
+ * With EXCEPTIONAL_DEFERRED_FORMAT, "throwf" and "rethrowf" don't format their
+ * messages when throwing. Instead, the exception keeps the format pointer and a
+ * compact copy of the arguments (strings included), and formats the message only
+ * when it is first requested via Exception_get_message or Exception_dump.
+ *
+ * The format itself is not copied, so it must outlive the exception (a string
+ * literal is fine). Formats with "%n", wide characters, or more than
+ * EXCEPTIONAL_MAX_FORMAT_ARGUMENTS arguments are formatted immediately.
+ */
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+
+#include <stdarg.h>
+#include <stddef.h>
+
+#ifndef EXCEPTIONAL_MAX_FORMAT_ARGUMENTS
+#define EXCEPTIONAL_MAX_FORMAT_ARGUMENTS 8
+#endif
+
+typedef union ExceptionFormatArgument {
+	int i;
+	long l;
+	long long ll;
+	intmax_t j;
+	size_t z;
+	ptrdiff_t t;
+	double d;
+	long double ld;
+	void *p;
+	char *s;
+} ExceptionFormatArgument;
+
+typedef struct ExceptionFormat {
+	const char *format;
+	int argument_count;
+	ExceptionFormatArgument arguments[EXCEPTIONAL_MAX_FORMAT_ARGUMENTS];
+	char *strings;
+	bool own_strings;
+	char inline_strings[EXCEPTIONAL_INLINE_MESSAGE_SIZE];
+} ExceptionFormat;
+
+bool ExceptionFormat_capture(ExceptionFormat *self, const char *format, va_list args);
+int ExceptionFormat_render(ExceptionFormat *self, char *buffer, size_t size);
+void ExceptionFormat_destroy(ExceptionFormat *self);
+
+#endif
+
+//
+// Exception
+//
+
 #define EXCEPTION_DUMP_SHORT  ((ExceptionDumpDetail) 0)
 #define EXCEPTION_DUMP_LONG   ((ExceptionDumpDetail) 1)
 #define EXCEPTION_DUMP_NESTED ((ExceptionDumpDetail) 2)
@@ -418,18 +694,162 @@ typedef struct Exception {
 	bool own_message;
 	ExceptionProgramLocation location;
 	struct Exception *cause;
-	ExceptionBacktrace *backtrace;
+	struct Exception *next; // in its ExceptionQueue
+	struct ExceptionAggregate *aggregate; // if collapsed by an ExceptionAggregator
+	const ExceptionBacktrace *backtrace;
+	char inline_message[EXCEPTIONAL_INLINE_MESSAGE_SIZE];
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+	ExceptionFormat deferred;
+#endif
 } Exception;
 
 Exception *Exception_new(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, char *message, bool own_message);
 Exception *Exception_newc(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, const char *message);
 Exception *Exception_newd(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, char *message);
 Exception *Exception_newf(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, const char *format, ...);
+const char *Exception_get_message(Exception *self);
+
+/*
+ * A 64-bit id over the exception's type, throw site, and backtrace (if captured), for
+ * grouping and counting exceptions. Stable for the life of the process.
+ */
+uint64_t Exception_fingerprint(Exception *self);
 void Exception_destroy(Exception *self);
 void Exception_destroy_and_free(Exception *self);
 void Exception_add_backtrace(Exception *exception);
 void Exception_dump(Exception *self, FILE *file, ExceptionDumpDetail detail);
 
+/*
+ * How many exceptions this one stands for (1 unless it was aggregated).
+ */
+unsigned long Exception_get_count(Exception *self);
+
+/*
+ * Copies the payloads of the first and of the last aggregated exceptions, oldest first,
+ * into arrays of EXCEPTIONAL_AGGREGATE_PAYLOADS. Returns how many were copied into each
+ * (0 unless the exception was aggregated).
+ */
+int Exception_get_payloads(Exception *self, long *first, long *last);
+
+//
+// ExceptionQueue
+//
+
+/*
+ * A FIFO of exceptions, linked through the exceptions themselves, so that appending
+ * never allocates and moving a whole queue to another (for relaying and capturing)
+ * is O(1). An exception can be in only one queue at a time.
+ */
+typedef struct ExceptionQueue {
+	Exception *head, *tail;
+	int count;
+} ExceptionQueue;
+
+#define exceptional_queue_for_each(QUEUE, VAR) \
+	for (Exception *VAR = (QUEUE)->head; VAR; VAR = VAR->next)
+
+void ExceptionQueue_create(ExceptionQueue *self);
+void ExceptionQueue_destroy(ExceptionQueue *self);
+void ExceptionQueue_append(ExceptionQueue *self, Exception *exception);
+
+/*
+ * Moves all exceptions from "source" to the end of the queue, leaving "source" empty.
+ */
+void ExceptionQueue_splice(ExceptionQueue *self, ExceptionQueue *source);
+
+/*
+ * Unlinks the exception following "previous" (or the head, if "previous" is NULL) and
+ * returns it.
+ */
+Exception *ExceptionQueue_remove(ExceptionQueue *self, Exception *previous);
+Exception *ExceptionQueue_get(ExceptionQueue *self, int index);
+
+/*
+ * For many producers and one consumer: moves all exceptions from the queue onto a
+ * shared lock-free stack (a single CAS per call), leaving the queue empty.
+ */
+void ExceptionQueue_push_stack(ExceptionQueue *self, Exception **stack);
+
+/*
+ * Takes everything from a shared stack filled by "ExceptionQueue_push_stack" and
+ * appends it to the queue, in the order in which it was pushed. Must not race with
+ * other takers.
+ */
+void ExceptionQueue_take_stack(ExceptionQueue *self, Exception **stack);
+
+//
+// ExceptionAggregator
+//
+
+/*
+ * How many of the first and of the last payloads an aggregated exception keeps.
+ */
+#ifndef EXCEPTIONAL_AGGREGATE_PAYLOADS
+#define EXCEPTIONAL_AGGREGATE_PAYLOADS 4
+#endif
+
+#ifndef EXCEPTIONAL_AGGREGATE_BUCKETS
+#define EXCEPTIONAL_AGGREGATE_BUCKETS 256
+#endif
+
+/*
+ * Owned by the representative exception. Under concurrency "last_payloads" is
+ * approximate: a ring written by whoever counted last.
+ */
+typedef struct ExceptionAggregate {
+	struct ExceptionAggregate *next;         // in its bucket
+	struct ExceptionAggregate *next_created; // see ExceptionAggregator
+	uint64_t hash;
+	Exception *exception;
+	unsigned long count;
+	long first_payloads[EXCEPTIONAL_AGGREGATE_PAYLOADS];
+	long last_payloads[EXCEPTIONAL_AGGREGATE_PAYLOADS];
+} ExceptionAggregate;
+
+/*
+ * Collapses exceptions of the same type and throw site (and optionally message) into
+ * one representative each. Any number of threads can add at the same time: buckets and
+ * the list of representatives are lock-free stacks, which only grow until taken.
+ */
+typedef struct ExceptionAggregator {
+	bool by_message;
+	ExceptionAggregate *created; // newest first
+	ExceptionAggregate *buckets[EXCEPTIONAL_AGGREGATE_BUCKETS];
+} ExceptionAggregator;
+
+ExceptionAggregator *ExceptionAggregator_new(bool by_message);
+void ExceptionAggregator_destroy_and_free(ExceptionAggregator *self);
+
+/*
+ * Takes ownership of the exception: it either becomes a new representative or is
+ * counted by an existing one and freed.
+ */
+void ExceptionAggregator_add(ExceptionAggregator *self, Exception *exception, long payload);
+
+/*
+ * Appends the representatives to the queue, in the order in which they were created,
+ * and starts over. Must not race with adders.
+ */
+void ExceptionAggregator_take(ExceptionAggregator *self, ExceptionQueue *queue);
+
+//
+// ExceptionPool
+//
+
+/*
+ * Exceptions (together with their backtraces) are allocated from per-thread pools,
+ * which grow by slabs of this many records. Records freed by the allocating thread
+ * go straight back to its pool, while records freed by other threads (for example,
+ * exceptions captured in OpenMP threads and released by the master) are handed back
+ * via a lock-free stack.
+ */
+#ifndef EXCEPTIONAL_POOL_SLAB_SIZE
+#define EXCEPTIONAL_POOL_SLAB_SIZE 64
+#endif
+
+Exception *ExceptionPool_allocate();
+void ExceptionPool_free(Exception *exception);
+
 //
 // ExceptionFrame
 //
@@ -440,8 +860,85 @@ void Exception_dump(Exception *self, FILE *file, ExceptionDumpDetail detail);
 
 typedef int JumpReason;
 
+/*
+ * Jump backend.
+ *
+ * By default we use the standard setjmp/longjmp. Define EXCEPTIONAL_JUMP_BUILTIN to
+ * instead use the GCC/Clang __builtin_setjmp/__builtin_longjmp, which save only the
+ * frame pointer, stack pointer and resume address (5 words instead of libc's full
+ * register set and signal mask, and without pointer mangling). Because
+ * __builtin_longjmp can only deliver the value 1, the jump reason is passed via the
+ * context.
+ *
+ * Define EXCEPTIONAL_JUMP_UNWIND (and compile everything with "-fexceptions") to
+ * propagate exceptions with the compiler's table-driven unwinder: throwing runs a
+ * forced unwind that walks the unwind tables up to the frame of the jump point,
+ * running the "__attribute__((cleanup))" handlers of all the functions in between,
+ * and only then lands in the jump point. The jump point itself is recorded as in
+ * EXCEPTIONAL_JUMP_BUILTIN, because C gives us no other way to resume inside a
+ * frame. Cleanup handlers must not throw.
+ *
+ * With both of these, every jump point in an OpenMP region also calls an empty
+ * "returns_twice" function: GCC doesn't tell the function it outlines for the region
+ * that it contains a __builtin_setjmp, and would otherwise optimize it as if the jump
+ * could never land there.
+ */
+#if defined(_OPENMP) && (defined(EXCEPTIONAL_JUMP_UNWIND) || defined(EXCEPTIONAL_JUMP_BUILTIN))
+void ExceptionContext_jump_point() __attribute__((returns_twice));
+#define EXCEPTIONAL_JUMP_POINT ExceptionContext_jump_point(),
+#else
+#define EXCEPTIONAL_JUMP_POINT
+#endif
+
+#if defined(EXCEPTIONAL_JUMP_UNWIND)
+#ifndef __EXCEPTIONS
+#error "EXCEPTIONAL_JUMP_UNWIND requires compiling with -fexceptions"
+#endif
+#include <unwind.h>
+#define EXCEPTIONAL_JUMP_BACKEND "unwind"
+#define EXCEPTIONAL_SETJMP(CONTEXT, BUFFER) \
+	(EXCEPTIONAL_JUMP_POINT __builtin_setjmp(BUFFER) ? (CONTEXT)->jump_reason : JUMP_REASON_DONT)
+typedef void *ExceptionJumpBuffer[5];
+#elif defined(EXCEPTIONAL_JUMP_BUILTIN)
+#define EXCEPTIONAL_JUMP_BACKEND "builtin"
+#define EXCEPTIONAL_SETJMP(CONTEXT, BUFFER) \
+	(EXCEPTIONAL_JUMP_POINT __builtin_setjmp(BUFFER) ? (CONTEXT)->jump_reason : JUMP_REASON_DONT)
+typedef void *ExceptionJumpBuffer[5];
+#else
+#define EXCEPTIONAL_JUMP_BACKEND "setjmp"
+#define EXCEPTIONAL_SETJMP(CONTEXT, BUFFER) \
+	setjmp(BUFFER)
+typedef jmp_buf ExceptionJumpBuffer;
+#endif
+
+/*
+ * Define EXCEPTIONAL_STACK_FRAMES to have the keywords allocate their frames on the
+ * caller's stack and link them into the context, instead of copying them into the
+ * context's own frame stack. The frame then only points to the caller's jump buffer, so
+ * entering a "try" is just a handful of stores.
+ *
+ * In this mode a frame lives exactly as long as the code block that declared it, so
+ * you must never leave a "try", "capture_exceptions" or "with_exceptions_relay" code
+ * block via "return", "break" or "goto".
+ */
+#ifdef EXCEPTIONAL_STACK_FRAMES
+#define EXCEPTIONAL_DECLARE_FRAME ExceptionFrame EXCEPTIONAL_LOCAL(frame);
+#define EXCEPTIONAL_FRAME         (&EXCEPTIONAL_LOCAL(frame))
+#else
+#define EXCEPTIONAL_DECLARE_FRAME
+#define EXCEPTIONAL_FRAME         NULL
+#endif
+
 typedef struct ExceptionFrame {
-	jmp_buf jmp;
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	ExceptionJumpBuffer *jmp;
+	struct ExceptionFrame *previous;
+#else
+	ExceptionJumpBuffer jmp;
+#ifdef EXCEPTIONAL_JUMP_UNWIND
+	ExceptionJumpBuffer *origin; // the caller's copy, which tells us where its stack frame is
+#endif
+#endif
 	const char *keyword;
 	ExceptionProgramLocation location;
 	bool trying, rethrowing;
@@ -454,23 +951,46 @@ void ExceptionFrame_dump(ExceptionFrame *self, FILE *file);
 // ExceptionContext
 //
 
+/*
+ * Unless EXCEPTIONAL_STACK_FRAMES is defined, the frame stack is contiguous: it grows
+ * geometrically, starting at this capacity, and never shrinks, so that entering a
+ * "try" does not allocate once warmed up.
+ */
+#ifndef EXCEPTIONAL_INITIAL_FRAMES
+#define EXCEPTIONAL_INITIAL_FRAMES 16
+#endif
+
+/*
+ * A zero-initialized context is valid and empty: nothing is allocated until the first
+ * "try" or "throw".
+ */
 typedef struct ExceptionContext {
-	bool valid;
-	list_t frames, exceptions;
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	ExceptionFrame *current_frame;
+#else
+	ExceptionFrame *frames;
+	int frame_count, frame_capacity;
+#endif
+	ExceptionQueue exceptions;
+#if defined(EXCEPTIONAL_JUMP_BUILTIN) || defined(EXCEPTIONAL_JUMP_UNWIND)
+	JumpReason jump_reason;
+#endif
+#ifdef EXCEPTIONAL_JUMP_UNWIND
+	struct _Unwind_Exception unwind_exception;
+	ExceptionJumpBuffer unwind_jmp;
+	void *unwind_origin;
+#endif
 } ExceptionContext;
 
 void ExceptionContext_create(ExceptionContext *self);
 void ExceptionContext_destroy(ExceptionContext *self);
+void ExceptionContext_reset(ExceptionContext *self);
 void ExceptionContext_destroy_and_free(ExceptionContext *self);
 
 // Frames
-void ExceptionContext_push_frame(ExceptionContext *self, jmp_buf *jmp, JumpReason finally_jump_reason, bool trying, bool rethrowing, const char *keyword, const char *file, int line, const char *fn);
-void ExceptionContext_pop_frame(ExceptionContext *self);
-ExceptionFrame *ExceptionContext_get_current_frame(ExceptionContext *self);
+void ExceptionContext_grow_frames(ExceptionContext *self) EXCEPTIONAL_COLD;
 void ExceptionContext_jump(ExceptionContext *self);
 void ExceptionContext_jump_because(ExceptionContext *self, JumpReason reason);
-bool ExceptionContext_is_trying(ExceptionContext *self);
-void ExceptionContext_stop_trying(ExceptionContext *self);
 void ExceptionContext_dump_frames(ExceptionContext *self, FILE *file);
 
 // Exceptions
@@ -481,40 +1001,162 @@ void ExceptionContext_clear_exceptions(ExceptionContext *self, bool except_first
 void ExceptionContext_dump_exceptions(ExceptionContext *self, FILE *file);
 
 // Helpers
-void ExceptionContext_try(ExceptionContext *self, jmp_buf *jmp, JumpReason reason, const char *file, int line, const char *fn);
-void ExceptionContext_throw(ExceptionContext *self, Exception *exception);
-Exception *ExceptionContext_catch(ExceptionContext *self, const ExceptionType *type);
+void ExceptionContext_try_slow(ExceptionContext *self, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *file, int line, const char *fn) EXCEPTIONAL_COLD;
+void ExceptionContext_throw(ExceptionContext *self, Exception *exception) EXCEPTIONAL_COLD;
+Exception *ExceptionContext_catch_slow(ExceptionContext *self, const ExceptionType *type) EXCEPTIONAL_COLD;
+Exception *ExceptionContext_catch_any(ExceptionContext *self, const ExceptionType **types, int *index);
 void ExceptionContext_catch_done(ExceptionContext *self, Exception *exception);
-void ExceptionContext_finally_done(ExceptionContext *self);
+void ExceptionContext_finally_done_slow(ExceptionContext *self) EXCEPTIONAL_COLD;
 int ExceptionContext_count_exceptions(ExceptionContext *self);
 Exception *ExceptionContext_get_exception(ExceptionContext *self, int index);
 
+/*
+ * Fast paths.
+ *
+ * These are inline so that a "try/finally" that doesn't throw compiles to a few
+ * instructions around the jump point. Anything to do with throwing or debugging is
+ * left to the out-of-line "_slow" functions.
+ */
+
+static inline ExceptionFrame *ExceptionContext_get_current_frame(ExceptionContext *self) {
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	return self->current_frame;
+#else
+	return self->frame_count ? &self->frames[self->frame_count - 1] : NULL;
+#endif
+}
+
+static inline void ExceptionContext_push_frame(ExceptionContext *self, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason finally_jump_reason, bool trying, bool rethrowing, const char *keyword, const char *file, int line, const char *fn) {
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	// The frame is owned by the caller's stack, so we only link it in
+	frame->jmp = jmp;
+	frame->previous = self->current_frame;
+	self->current_frame = frame;
+#else
+	// "frame" is always NULL here: we use our own storage
+	if (EXCEPTIONAL_UNLIKELY(self->frame_count == self->frame_capacity))
+		ExceptionContext_grow_frames(self);
+	frame = &self->frames[self->frame_count++];
+	memcpy(frame->jmp, jmp, sizeof(ExceptionJumpBuffer));
+#ifdef EXCEPTIONAL_JUMP_UNWIND
+	frame->origin = jmp;
+#endif
+#endif
+	frame->finally_jump_reason = finally_jump_reason;
+	frame->trying = trying;
+	frame->rethrowing = rethrowing;
+	frame->keyword = keyword;
+	frame->location.file = file;
+	frame->location.line = line;
+	frame->location.fn = fn;
+}
+
+static inline void ExceptionContext_pop_frame(ExceptionContext *self) {
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	ExceptionFrame *frame = self->current_frame;
+	if (frame) {
+		self->current_frame = frame->previous;
+		// Maintain the reason on the last frame
+		if (self->current_frame)
+			self->current_frame->finally_jump_reason = frame->finally_jump_reason;
+	}
+#else
+	if (self->frame_count) {
+		JumpReason finally_jump_reason = self->frames[--self->frame_count].finally_jump_reason;
+		// Maintain the reason on the last frame
+		if (self->frame_count)
+			self->frames[self->frame_count - 1].finally_jump_reason = finally_jump_reason;
+	}
+#endif
+}
+
+static inline bool ExceptionContext_is_trying(ExceptionContext *self) {
+	ExceptionFrame *frame = ExceptionContext_get_current_frame(self);
+	return frame && frame->trying;
+}
+
+static inline void ExceptionContext_stop_trying(ExceptionContext *self) {
+	ExceptionFrame *frame = ExceptionContext_get_current_frame(self);
+	if (frame)
+		frame->trying = false;
+}
+
+static inline void ExceptionContext_try(ExceptionContext *self, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *file, int line, const char *fn) {
+	if (EXCEPTIONAL_UNLIKELY(reason) || EXCEPTIONAL_DEBUGGING)
+		ExceptionContext_try_slow(self, frame, jmp, reason, file, line, fn);
+	else
+		// All we did was set the jump point
+		ExceptionContext_push_frame(self, frame, jmp, JUMP_REASON_DONT, true, false, "try", file, line, fn);
+}
+
+static inline Exception *ExceptionContext_catch(ExceptionContext *self, const ExceptionType *type) {
+	if (EXCEPTIONAL_LIKELY(!self->exceptions.head) && !EXCEPTIONAL_DEBUGGING)
+		// Nothing was thrown
+		return NULL;
+	return ExceptionContext_catch_slow(self, type);
+}
+
+static inline void ExceptionContext_finally_done(ExceptionContext *self) {
+	ExceptionFrame *frame = ExceptionContext_get_current_frame(self);
+	if (EXCEPTIONAL_LIKELY(frame && (frame->finally_jump_reason == JUMP_REASON_DONT)) && !EXCEPTIONAL_DEBUGGING) {
+		// Not unwinding, so we just leave the "try"
+#ifdef EXCEPTIONAL_STACK_FRAMES
+		self->current_frame = frame->previous;
+#else
+		self->frame_count--;
+#endif
+	}
+	else
+		ExceptionContext_finally_done_slow(self);
+}
+
 //
 // ExceptionScope
 //
 
 typedef ExceptionContext *(*ExceptionScope_get_fn)(void *reference);
+typedef void (*ExceptionScope_destroy_fn)(void *reference);
 
+/*
+ * Creating a scope only stores its functions: its context is looked up on first use
+ * ("get"), and only scopes that own their context need a "destroy". Each scope type's
+ * "_new" returns it by value with just these set, because everything else (including a
+ * local context) is valid zero-initialized; the keywords initialize their scopes in place
+ * this way, which is cheaper than creating them and then copying. "_create" is the same
+ * for an existing scope.
+ *
+ * Captured exceptions are pushed by any number of threads onto a lock-free stack, and
+ * put back in order when they are uncaptured.
+ */
 typedef struct ExceptionScope {
 	ExceptionScope_get_fn get;
-	list_t captured_exceptions;
+	ExceptionScope_destroy_fn destroy;
+	Exception *captured_exceptions; // see ExceptionQueue_push_stack
+	ExceptionAggregator *aggregator; // if aggregating captured exceptions
+	bool cancelled; // see "capture_exceptions_or_cancel"
 	bool done;
-	#ifdef _OPENMP
-	omp_lock_t lock;
-	#endif
 } ExceptionScope;
 
 void ExceptionScope_create(ExceptionScope *self);
 void ExceptionScope_destroy(ExceptionScope *self);
 void ExceptionScope_move_exceptions_to_other_context(ExceptionScope *self, ExceptionScope *relay);
-void ExceptionScope_move_exceptions_from_context(ExceptionScope *self);
+void ExceptionScope_move_exceptions_from_context(ExceptionScope *self, long payload);
 void ExceptionScope_move_exceptions_to_context(ExceptionScope *self);
 void ExceptionScope_dump_captured_exceptions(ExceptionScope *self, FILE *file);
+void ExceptionScope_aggregate(ExceptionScope *self, bool by_message);
+void ExceptionScope_cancel(ExceptionScope *self);
+
+// Polled by "capture_exceptions_or_cancel" and "capture_task_exceptions_or_cancel"
+static inline bool ExceptionScope_is_cancelled(ExceptionScope *self) {
+	return __atomic_load_n(&self->cancelled, __ATOMIC_RELAXED);
+}
 
 // Helpers
-bool ExceptionScope_with_exceptions_relay(ExceptionScope *self, ExceptionScope *relay, jmp_buf *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn);
+bool ExceptionScope_with_exceptions_relay(ExceptionScope *self, ExceptionScope *relay, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn);
 void ExceptionScope_with_exceptions_relay_done(ExceptionScope *self, ExceptionScope *relay);
-bool ExceptionScope_capture_exceptions(ExceptionScope *self, jmp_buf *jmp, JumpReason reason, const char *file, int line, const char *fn);
+bool ExceptionScope_with_exceptions_relay_to(ExceptionScope *self, ExceptionScope *relay, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn);
+void ExceptionScope_with_exceptions_relay_to_done(ExceptionScope *self, ExceptionScope *relay);
+bool ExceptionScope_capture_exceptions(ExceptionScope *self, long payload, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *file, int line, const char *fn);
 void ExceptionScope_uncapture_exceptions(ExceptionScope *self);
 void ExceptionScope_throw_captured(ExceptionScope *self);
 
@@ -531,6 +1173,10 @@ typedef struct ExceptionScope_global {
 	ExceptionScope super;
 } ExceptionScope_global;
 
+typedef struct ExceptionScope_tls {
+	ExceptionScope super;
+} ExceptionScope_tls;
+
 typedef struct ExceptionScope_posix {
 	ExceptionScope super;
 	ExceptionContext *context;
@@ -545,43 +1191,158 @@ typedef struct ExceptionScope_openmp {
 	ExceptionScope super;
 } ExceptionScope_openmp;
 
+/*
+ * Context lookup. "get_current_exception_context" calls "current_exception_scope_get",
+ * which is this generic version in "WITH_EXCEPTIONS" functions, but inside
+ * "with_exceptions" code blocks is shadowed by the "get_context" of the concrete
+ * scope type. These are inline, so the compiler can resolve the context without an
+ * indirect call.
+ */
+static inline ExceptionContext *current_exception_scope_get(void *scope) {
+	return ((ExceptionScope *) scope)->get(scope);
+}
+
 // Local
 void ExceptionScope_local_create(ExceptionScope_local *self);
 ExceptionScope_local ExceptionScope_local_new();
 
+static inline ExceptionContext *ExceptionScope_local_get_context(void *scope) {
+	return &((ExceptionScope_local *) scope)->local_context;
+}
+
 // Global
+extern ExceptionContext exception_context_global;
+
 void ExceptionScope_shutdown_global();
 void ExceptionScope_global_create(ExceptionScope_global *self);
 ExceptionScope_global ExceptionScope_global_new();
 
+static inline ExceptionContext *ExceptionScope_global_get_context(void *scope) {
+	return &exception_context_global;
+}
+
+// Thread-local storage (via "__thread": needs no initialization)
+extern __thread ExceptionContext exception_context_tls;
+
+void ExceptionScope_tls_create(ExceptionScope_tls *self);
+ExceptionScope_tls ExceptionScope_tls_new();
+
+static inline ExceptionContext *ExceptionScope_tls_get_context(void *scope) {
+	return &exception_context_tls;
+}
+
 // POSIX
 void ExceptionScope_initialize_posix();
 void ExceptionScope_shutdown_posix();
 void ExceptionScope_posix_create(ExceptionScope_posix *self);
 ExceptionScope_posix ExceptionScope_posix_new();
+ExceptionContext *ExceptionScope_posix_get(ExceptionScope_posix *self);
+
+static inline ExceptionContext *ExceptionScope_posix_get_context(void *scope) {
+	ExceptionContext *context = ((ExceptionScope_posix *) scope)->context;
+	return context ? context : ExceptionScope_posix_get(scope);
+}
 
 // SDL
 void ExceptionScope_initialize_sdl();
 void ExceptionScope_sdl_create(ExceptionScope_sdl *self);
 ExceptionScope_sdl ExceptionScope_sdl_new();
+ExceptionContext *ExceptionScope_sdl_get(ExceptionScope_sdl *self);
+
+static inline ExceptionContext *ExceptionScope_sdl_get_context(void *scope) {
+	ExceptionContext *context = ((ExceptionScope_sdl *) scope)->context;
+	return context ? context : ExceptionScope_sdl_get(scope);
+}
 
 // OpenMP
 #ifdef _OPENMP
+
+/*
+ * Every thread has a context per nesting level of parallel regions (omp_get_level), so
+ * that a "with_exceptions (openmp)" in an inner team doesn't share its context with the
+ * outer team. Deeper levels share the last context.
+ */
+#ifndef EXCEPTIONAL_OPENMP_LEVELS
+#define EXCEPTIONAL_OPENMP_LEVELS 8
+#endif
+
 void ExceptionScope_initialize_openmp();
 void ExceptionScope_shutdown_openmp();
 void ExceptionScope_openmp_create(ExceptionScope_openmp *self);
 ExceptionScope_openmp ExceptionScope_openmp_new();
+ExceptionContext *ExceptionScope_openmp_get(ExceptionScope_openmp *self);
+
+static inline ExceptionContext *ExceptionScope_openmp_get_context(void *scope) {
+	return ExceptionScope_openmp_get(scope);
+}
 #endif
 
 //
 // Utilities
 //
 
+// Shadows "current_exception_scope_get" with the concrete "get_context" for the following
+// code block (runs once: the enclosing scope loop checks "done" again after us)
+#define EXCEPTIONAL_BIND_GET(CONTEXT) \
+	for (ExceptionScope_get_fn const current_exception_scope_get __attribute__((unused)) = ExceptionScope_##CONTEXT##_get_context; \
+		!current_exception_scope->done; current_exception_scope->done = true)
+
+#ifdef _OPENMP
+#define EXCEPTIONAL_OMP_PRAGMA(X) _Pragma(#X)
+#else
+#define EXCEPTIONAL_OMP_PRAGMA(X)
+#endif
+
+// CONSTRUCT is "for" or "taskgroup" (without OpenMP, we rely on the polled flag alone)
+#define EXCEPTIONAL_CAPTURE_EXCEPTIONS_OR_CANCEL(CONSTRUCT) \
+	EXCEPTIONAL_OMP_PRAGMA(omp cancellation point CONSTRUCT) \
+	ExceptionContext *EXCEPTIONAL_LOCAL(exception_context) = get_current_exception_context(); \
+	/* Create a jump point. */ \
+	EXCEPTIONAL_DECLARE_FRAME \
+	ExceptionJumpBuffer EXCEPTIONAL_LOCAL(jmp); \
+	JumpReason EXCEPTIONAL_LOCAL(jump_reason) = EXCEPTIONAL_SETJMP(EXCEPTIONAL_LOCAL(exception_context), EXCEPTIONAL_LOCAL(jmp)); \
+	if (EXCEPTIONAL_UNLIKELY(EXCEPTIONAL_LOCAL(jump_reason))) { \
+		/* Moves all uncaught exceptions to the scope and cancels. */ \
+		ExceptionScope_capture_exceptions(current_exception_scope, 0, EXCEPTIONAL_FRAME, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), __FILE__, __LINE__, __FUNCTION__); \
+		ExceptionScope_cancel(current_exception_scope); \
+		EXCEPTIONAL_OMP_PRAGMA(omp cancel CONSTRUCT) \
+	} \
+	/* Executes the code block, unless cancelled. */ \
+	else if (!ExceptionScope_is_cancelled(current_exception_scope) \
+		&& ExceptionScope_capture_exceptions(current_exception_scope, 0, EXCEPTIONAL_FRAME, &EXCEPTIONAL_LOCAL(jmp), EXCEPTIONAL_LOCAL(jump_reason), __FILE__, __LINE__, __FUNCTION__)) \
+		for (bool done_ = false; !done_; done_ = true, \
+			ExceptionContext_pop_frame(EXCEPTIONAL_LOCAL(exception_context)))
+
 #define EXCEPTIONAL_LOCAL(PREFIX)          EXCEPTIONAL_LOCAL1(PREFIX, __LINE__)
 // We need these two layers of macros because C is weird
 #define EXCEPTIONAL_LOCAL1(PREFIX, SUFFIX) EXCEPTIONAL_LOCAL2(PREFIX, SUFFIX)
 #define EXCEPTIONAL_LOCAL2(PREFIX, SUFFIX) PREFIX##_##SUFFIX##_
 
+// Expands to pointers to the exception types (up to 16)
+#define EXCEPTIONAL_TYPES(...) \
+	EXCEPTIONAL_TYPES1(EXCEPTIONAL_COUNT(__VA_ARGS__), __VA_ARGS__)
+#define EXCEPTIONAL_TYPES1(COUNT, ...) EXCEPTIONAL_TYPES2(COUNT, __VA_ARGS__)
+#define EXCEPTIONAL_TYPES2(COUNT, ...) EXCEPTIONAL_TYPES_##COUNT(__VA_ARGS__)
+#define EXCEPTIONAL_COUNT(...) \
+	EXCEPTIONAL_COUNT1(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define EXCEPTIONAL_COUNT1(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define EXCEPTIONAL_TYPES_1(T) &ExceptionType##T
+#define EXCEPTIONAL_TYPES_2(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_1(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_3(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_2(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_4(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_3(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_5(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_4(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_6(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_5(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_7(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_6(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_8(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_7(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_9(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_8(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_10(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_9(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_11(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_10(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_12(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_11(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_13(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_12(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_14(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_13(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_15(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_14(__VA_ARGS__)
+#define EXCEPTIONAL_TYPES_16(T, ...) &ExceptionType##T, EXCEPTIONAL_TYPES_15(__VA_ARGS__)
+
 // ANSI terminal colors
 
 #define ANSI_COLOR_RED            "\x1b[31m"
@@ -605,20 +1366,5 @@ void exceptional_dump_fn(FILE *file, const char *fn, const char *tag, const char
 char *exceptional_bstring_to_string(bstring string_b);
 char *exceptional_strdup(const char *string);
 char *exceptional_sprintf(size_t max_size, const char *format, va_list args);
-char *exceptional_escape_spaces(const char *string);
-
-// SimCList
-
-#define exceptional_list_for_each(LIST, TYPE, VAR) \
-	list_t *EXCEPTIONAL_LOCAL(list) = LIST; \
-	if (!list_empty(EXCEPTIONAL_LOCAL(list)) && list_iterator_start(EXCEPTIONAL_LOCAL(list))) \
-		for (bool next_ = list_iterator_hasnext(EXCEPTIONAL_LOCAL(list)); next_; next_ = false, list_iterator_stop(EXCEPTIONAL_LOCAL(list))) \
-			for (TYPE *VAR = list_iterator_next(EXCEPTIONAL_LOCAL(list)); next_; next_ = list_iterator_hasnext(EXCEPTIONAL_LOCAL(list)), VAR = next_ ? list_iterator_next(EXCEPTIONAL_LOCAL(list)) : NULL)
-
-typedef void (*exceptional_list_destroy_element_fn)(void *element);
-
-bool exceptional_list_initialized(list_t *list);
-void exceptional_list_move(list_t *source, list_t *destination);
-bool exceptional_list_destroy_with_elements(list_t *list, exceptional_list_destroy_element_fn destroy_element);
 
 #endif
@@ -1,21 +1,73 @@
 #include "exceptional.h"
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
+
+static void Exception_copy_message(Exception *self, const char *message) {
+	if (!message) {
+		self->message = NULL;
+		self->own_message = false;
+		return;
+	}
+
+	size_t size = strlen(message) + 1;
+	if (size <= EXCEPTIONAL_INLINE_MESSAGE_SIZE) {
+		self->message = self->inline_message;
+		self->own_message = false;
+	}
+	else {
+		self->message = malloc(size);
+		self->own_message = true;
+	}
+	memcpy(self->message, message, size);
+}
+
+static void Exception_format_message(Exception *self, const char *format, va_list args) {
+	if (!format) {
+		Exception_copy_message(self, NULL);
+		return;
+	}
+
+	va_list args_copy;
+	va_copy(args_copy, args);
+
+	// First pass straight into the inline buffer, which also tells us the exact size
+	int length = vsnprintf(self->inline_message, EXCEPTIONAL_INLINE_MESSAGE_SIZE, format, args);
+	if (length < 0)
+		// Bad format
+		Exception_copy_message(self, format);
+	else if (length < EXCEPTIONAL_INLINE_MESSAGE_SIZE) {
+		self->message = self->inline_message;
+		self->own_message = false;
+	}
+	else {
+		self->message = malloc(length + 1);
+		self->own_message = true;
+		vsnprintf(self->message, length + 1, format, args_copy);
+	}
+
+	va_end(args_copy);
+}
 
 Exception *Exception_new(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, char *message, bool own_message) {
-	Exception *exception = malloc(sizeof(Exception));
+	Exception *exception = ExceptionPool_allocate();
 	exception->type = type;
 	exception->cause = cause;
+	exception->next = NULL;
+	exception->aggregate = NULL;
 	exception->location.file = file;
 	exception->location.line = line;
 	exception->location.fn = fn;
 	exception->message = message;
 	exception->own_message = own_message;
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+	exception->deferred.format = NULL;
+#endif
 
 #ifdef EXCEPTIONAL_BACKTRACE
-	exception->backtrace = malloc(sizeof(ExceptionBacktrace));
-	ExceptionBacktrace_create(exception->backtrace);
-	exception->backtrace->skip++;
+	exception->backtrace = ExceptionBacktrace_create(type);
+#else
+	exception->backtrace = NULL;
 #endif
 
 	return exception;
@@ -26,13 +78,41 @@ Exception *Exception_newc(const ExceptionType *type, Exception *cause, const cha
 }
 
 Exception *Exception_newd(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, char *message) {
-	return Exception_new(type, cause, file, line, fn, exceptional_strdup(message), true);
+	Exception *exception = Exception_new(type, cause, file, line, fn, NULL, false);
+	Exception_copy_message(exception, message);
+	return exception;
 }
 
 Exception *Exception_newf(const ExceptionType *type, Exception *cause, const char *file, int line, const char *fn, const char *format, ...) {
+	Exception *exception = Exception_new(type, cause, file, line, fn, NULL, false);
 	va_list args;
 	va_start(args, format);
-	return Exception_new(type, cause, file, line, fn, exceptional_sprintf(EXCEPTIONAL_MAX_MESSAGE_SIZE, format, args), true);
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+	// Falls back to formatting now if the format can't be deferred
+	if (!ExceptionFormat_capture(&exception->deferred, format, args))
+#endif
+	Exception_format_message(exception, format, args);
+	va_end(args);
+	return exception;
+}
+
+const char *Exception_get_message(Exception *self) {
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+	if (self->deferred.format) {
+		int length = ExceptionFormat_render(&self->deferred, self->inline_message, EXCEPTIONAL_INLINE_MESSAGE_SIZE);
+		if (length < EXCEPTIONAL_INLINE_MESSAGE_SIZE) {
+			self->message = self->inline_message;
+			self->own_message = false;
+		}
+		else {
+			self->message = malloc(length + 1);
+			self->own_message = true;
+			ExceptionFormat_render(&self->deferred, self->message, length + 1);
+		}
+		ExceptionFormat_destroy(&self->deferred);
+	}
+#endif
+	return self->message;
 }
 
 void Exception_destroy(Exception *self) {
@@ -40,22 +120,74 @@ void Exception_destroy(Exception *self) {
 		free(self->message);
 		self->message = NULL;
 	}
-	if (self->backtrace) {
-		free(self->backtrace);
-		self->backtrace = NULL;
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+	if (self->deferred.format)
+		ExceptionFormat_destroy(&self->deferred);
+#endif
+	if (self->aggregate) {
+		free(self->aggregate);
+		self->aggregate = NULL;
 	}
-	while (true) {
-		self = self->cause;
-		if (self)
-			Exception_destroy_and_free(self);
-		else
-			break;
+	// The cause destroys its own cause, and so on
+	if (self->cause) {
+		Exception_destroy_and_free(self->cause);
+		self->cause = NULL;
 	}
 }
 
 void Exception_destroy_and_free(Exception *self) {
 	Exception_destroy(self);
-	free(self);
+	ExceptionPool_free(self);
+}
+
+uint64_t Exception_fingerprint(Exception *self) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint64_t parts[] = {
+		(uintptr_t) self->type,
+		(uintptr_t) self->location.file,
+		(uint64_t) self->location.line,
+		self->backtrace ? self->backtrace->hash : 0 };
+	for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+		hash ^= parts[i];
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+unsigned long Exception_get_count(Exception *self) {
+	return self->aggregate ? __atomic_load_n(&self->aggregate->count, __ATOMIC_RELAXED) : 1;
+}
+
+int Exception_get_payloads(Exception *self, long *first, long *last) {
+	if (!self->aggregate)
+		return 0;
+
+	unsigned long count = Exception_get_count(self);
+	int length = count < EXCEPTIONAL_AGGREGATE_PAYLOADS ? (int) count : EXCEPTIONAL_AGGREGATE_PAYLOADS;
+
+	// "last_payloads" is a ring: the oldest is the one that would be overwritten next
+	int oldest = count > EXCEPTIONAL_AGGREGATE_PAYLOADS ? (int) (count % EXCEPTIONAL_AGGREGATE_PAYLOADS) : 0;
+	for (int i = 0; i < length; i++) {
+		first[i] = __atomic_load_n(&self->aggregate->first_payloads[i], __ATOMIC_RELAXED);
+		last[i] = __atomic_load_n(&self->aggregate->last_payloads[(oldest + i) % EXCEPTIONAL_AGGREGATE_PAYLOADS], __ATOMIC_RELAXED);
+	}
+	return length;
+}
+
+static void Exception_dump_aggregate(Exception *self, FILE *file) {
+	if (!self->aggregate)
+		return;
+
+	long first[EXCEPTIONAL_AGGREGATE_PAYLOADS], last[EXCEPTIONAL_AGGREGATE_PAYLOADS];
+	int length = Exception_get_payloads(self, first, last);
+	fprintf(file, "  Occurred %lu times, first payloads:", Exception_get_count(self));
+	for (int i = 0; i < length; i++)
+		fprintf(file, " %ld", first[i]);
+	fprintf(file, ", last payloads:");
+	for (int i = 0; i < length; i++)
+		fprintf(file, " %ld", last[i]);
+	fprintf(file, "\n");
 }
 
 static void Exception_dump_causes(Exception *self, FILE *file) {
@@ -67,19 +199,22 @@ static void Exception_dump_causes(Exception *self, FILE *file) {
 }
 
 void Exception_dump(Exception *self, FILE *file, ExceptionDumpDetail detail) {
+	const char *message = Exception_get_message(self);
 	switch (detail) {
 	case EXCEPTION_DUMP_SHORT:
-		fprintf(file, "%s: %s\n", self->type->name, self->message);
+		fprintf(file, "%s: %s\n", self->type->name, message);
 		break;
 	case EXCEPTION_DUMP_LONG:
-		fprintf(file, "%s: %s at %s:%d %s()\n", self->type->name, self->message, self->location.file, self->location.line, self->location.fn);
+		fprintf(file, "%s: %s at %s:%d %s()\n", self->type->name, message, self->location.file, self->location.line, self->location.fn);
+		Exception_dump_aggregate(self, file);
 #ifdef EXCEPTIONAL_BACKTRACE
 		if (self->backtrace)
 			ExceptionBacktrace_dump(self->backtrace, file);
 #endif
 		break;
 	case EXCEPTION_DUMP_NESTED:
-		fprintf(file, "%s: %s at %s:%d %s()\n", self->type->name, self->message, self->location.file, self->location.line, self->location.fn);
+		fprintf(file, "%s: %s at %s:%d %s()\n", self->type->name, message, self->location.file, self->location.line, self->location.fn);
+		Exception_dump_aggregate(self, file);
 #ifdef EXCEPTIONAL_BACKTRACE
 		if (self->backtrace)
 			ExceptionBacktrace_dump(self->backtrace, file);
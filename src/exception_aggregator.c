@@ -0,0 +1,155 @@
+#include "exceptional.h"
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t ExceptionAggregator_hash(ExceptionAggregator *self, Exception *exception) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint64_t parts[] = {
+		(uintptr_t) exception->type,
+		(uintptr_t) exception->location.file,
+		(uint64_t) exception->location.line };
+	for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+		hash ^= parts[i];
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 32;
+	}
+
+	if (self->by_message) {
+		const char *message = Exception_get_message(exception);
+		if (message)
+			for (const char *c = message; *c; c++) {
+				hash ^= (unsigned char) *c;
+				hash *= 0x100000001b3ULL;
+			}
+	}
+
+	return hash;
+}
+
+static bool ExceptionAggregator_same(ExceptionAggregator *self, ExceptionAggregate *aggregate, uint64_t hash, Exception *exception) {
+	Exception *representative = aggregate->exception;
+	if ((aggregate->hash != hash) || (representative->type != exception->type)
+		|| (representative->location.file != exception->location.file) || (representative->location.line != exception->location.line))
+		return false;
+	if (!self->by_message)
+		return true;
+
+	// The representative's message was rendered before it was published, so we only read it
+	const char *message = Exception_get_message(exception);
+	const char *representative_message = representative->message;
+	if (!message || !representative_message)
+		return message == representative_message;
+	return !strcmp(message, representative_message);
+}
+
+// Searches from "head" up to (but not including) "end"
+static ExceptionAggregate *ExceptionAggregator_find(ExceptionAggregator *self, ExceptionAggregate *head, ExceptionAggregate *end, uint64_t hash, Exception *exception) {
+	for (ExceptionAggregate *aggregate = head; aggregate != end; aggregate = aggregate->next)
+		if (ExceptionAggregator_same(self, aggregate, hash, exception))
+			return aggregate;
+	return NULL;
+}
+
+static void ExceptionAggregate_count(ExceptionAggregate *self, long payload) {
+	unsigned long count = __atomic_add_fetch(&self->count, 1, __ATOMIC_RELAXED);
+	if (count <= EXCEPTIONAL_AGGREGATE_PAYLOADS)
+		__atomic_store_n(&self->first_payloads[count - 1], payload, __ATOMIC_RELAXED);
+	__atomic_store_n(&self->last_payloads[(count - 1) % EXCEPTIONAL_AGGREGATE_PAYLOADS], payload, __ATOMIC_RELAXED);
+}
+
+// The exception was a representative before (it was caught, and then captured again), so
+// its occurrences are added to ours in the order in which they were counted
+static void ExceptionAggregate_merge(ExceptionAggregate *self, Exception *exception) {
+	long first[EXCEPTIONAL_AGGREGATE_PAYLOADS], last[EXCEPTIONAL_AGGREGATE_PAYLOADS];
+	unsigned long count = Exception_get_count(exception);
+	int length = Exception_get_payloads(exception, first, last);
+	for (int i = 0; i < length; i++)
+		ExceptionAggregate_count(self, first[i]);
+	if (count > (unsigned long) length) {
+		// Occurrences between the first and last payloads are only counted
+		int last_length = count - length < EXCEPTIONAL_AGGREGATE_PAYLOADS ? (int) (count - length) : EXCEPTIONAL_AGGREGATE_PAYLOADS;
+		__atomic_add_fetch(&self->count, count - length - last_length, __ATOMIC_RELAXED);
+		for (int i = length - last_length; i < length; i++)
+			ExceptionAggregate_count(self, last[i]);
+	}
+}
+
+ExceptionAggregator *ExceptionAggregator_new(bool by_message) {
+	ExceptionAggregator *self = calloc(1, sizeof(ExceptionAggregator));
+	self->by_message = by_message;
+	return self;
+}
+
+void ExceptionAggregator_destroy_and_free(ExceptionAggregator *self) {
+	ExceptionQueue representatives;
+	ExceptionQueue_create(&representatives);
+	ExceptionAggregator_take(self, &representatives);
+	ExceptionQueue_destroy(&representatives);
+	free(self);
+}
+
+void ExceptionAggregator_add(ExceptionAggregator *self, Exception *exception, long payload) {
+	uint64_t hash = ExceptionAggregator_hash(self, exception);
+	ExceptionAggregate **bucket = &self->buckets[hash % EXCEPTIONAL_AGGREGATE_BUCKETS];
+	ExceptionAggregate *created = NULL;
+	ExceptionAggregate *searched = NULL; // everything from here on was already searched
+
+	ExceptionAggregate *head = __atomic_load_n(bucket, __ATOMIC_ACQUIRE);
+	while (true) {
+		ExceptionAggregate *aggregate = ExceptionAggregator_find(self, head, searched, hash, exception);
+		if (aggregate) {
+			// Someone else (maybe after winning a race against us) is the representative
+			if (created && (created != exception->aggregate))
+				free(created);
+			if (exception->aggregate)
+				ExceptionAggregate_merge(aggregate, exception);
+			ExceptionAggregate_count(aggregate, payload);
+			Exception_destroy_and_free(exception);
+			return;
+		}
+
+		if (!created) {
+			// A former representative keeps its aggregate, and with it its occurrences
+			created = exception->aggregate ? exception->aggregate : calloc(1, sizeof(ExceptionAggregate));
+			created->hash = hash;
+			created->exception = exception;
+			// Other threads will read the message, so it must not be rendered lazily
+			Exception_get_message(exception);
+		}
+
+		created->next = head;
+		if (__atomic_compare_exchange_n(bucket, &head, created, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+			break;
+		searched = created->next;
+	}
+
+	exception->aggregate = created;
+	ExceptionAggregate_count(created, payload);
+
+	ExceptionAggregate *newest = __atomic_load_n(&self->created, __ATOMIC_RELAXED);
+	do
+		created->next_created = newest;
+	while (!__atomic_compare_exchange_n(&self->created, &newest, created, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+void ExceptionAggregator_take(ExceptionAggregator *self, ExceptionQueue *queue) {
+	if (!__atomic_load_n(&self->created, __ATOMIC_RELAXED))
+		return;
+
+	ExceptionAggregate *reversed = NULL;
+	for (ExceptionAggregate *aggregate = __atomic_exchange_n(&self->created, NULL, __ATOMIC_ACQUIRE), *next; aggregate; aggregate = next) {
+		next = aggregate->next_created;
+		aggregate->next_created = reversed;
+		reversed = aggregate;
+	}
+
+	// The aggregates stay with their representatives
+	for (ExceptionAggregate *aggregate = reversed, *next; aggregate; aggregate = next) {
+		next = aggregate->next_created;
+		aggregate->next = NULL;
+		aggregate->next_created = NULL;
+		ExceptionQueue_append(queue, aggregate->exception);
+	}
+
+	memset(self->buckets, 0, sizeof(self->buckets));
+}
@@ -1,73 +1,243 @@
 #ifdef EXCEPTIONAL_BACKTRACE
 
-#define _POSIX_C_SOURCE 2 // for popen
-#define _XOPEN_SOURCE 500 // for readlink
+#ifdef EXCEPTIONAL_BACKTRACE_FRAME_POINTERS
+#define _GNU_SOURCE // for pthread_getattr_np
+#endif
 
 #include "exceptional.h"
 #include <execinfo.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <unistd.h>
+#include <string.h>
+
+#ifdef EXCEPTIONAL_BACKTRACE_FRAME_POINTERS
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#error "EXCEPTIONAL_BACKTRACE_FRAME_POINTERS is only supported on x86-64 and AArch64"
+#endif
+
+#include <pthread.h>
+
+// The walk starts at the return address into our caller
+#define OWN_FRAMES 0
+
+// Bounds of the current thread's stack, for validating frame pointers
+static __thread char *stack_low = NULL;
+static __thread char *stack_high = NULL;
+
+#else
+
+// backtrace() includes ExceptionBacktrace_create itself
+#define OWN_FRAMES 1
+
+#endif
+
+typedef struct ExceptionBacktracePolicy {
+	const ExceptionType *type;
+	unsigned int sample_rate;
+	int max_depth;
+	unsigned long counter;
+} ExceptionBacktracePolicy;
+
+static ExceptionBacktracePolicy default_policy = { NULL, 1, 0, 0 };
+static ExceptionBacktracePolicy policies[EXCEPTIONAL_MAX_BACKTRACE_POLICIES];
+static int policy_count = 0; // published with release, so readers don't need the lock
+static bool policies_lock = false;
 
-static bool addr2line(void *line, FILE *file);
-static bool get_exe_name(__pid_t pid, char *exe_name, size_t exe_name_size);
+bool ExceptionBacktrace_set_policy(const ExceptionType *type, unsigned int sample_rate, int max_depth) {
+	if ((max_depth <= 0) || (max_depth > EXCEPTION_MAX_BACKTRACE_SIZE))
+		max_depth = 0;
 
-void ExceptionBacktrace_create(ExceptionBacktrace *self) {
-	self->size = backtrace(self->frames, EXCEPTION_MAX_BACKTRACE_SIZE);
-	self->skip = 1;
+	ExceptionBacktracePolicy *policy = NULL;
+	bool added = false;
+	while (__atomic_test_and_set(&policies_lock, __ATOMIC_ACQUIRE));
+	if (!type)
+		policy = &default_policy;
+	else {
+		for (int i = 0; i < policy_count; i++)
+			if (policies[i].type == type) {
+				policy = &policies[i];
+				break;
+			}
+		if (!policy && (policy_count < EXCEPTIONAL_MAX_BACKTRACE_POLICIES)) {
+			policy = &policies[policy_count];
+			policy->type = type;
+			policy->counter = 0;
+			added = true;
+		}
+	}
+	if (policy) {
+		__atomic_store_n(&policy->sample_rate, sample_rate, __ATOMIC_RELAXED);
+		__atomic_store_n(&policy->max_depth, max_depth, __ATOMIC_RELAXED);
+		if (added)
+			__atomic_store_n(&policy_count, policy_count + 1, __ATOMIC_RELEASE);
+	}
+	__atomic_clear(&policies_lock, __ATOMIC_RELEASE);
+
+	return policy != NULL;
 }
 
-void ExceptionBacktrace_dump(ExceptionBacktrace *self, FILE *file) {
-	char **strings = backtrace_symbols(self->frames, self->size);
-	if (strings) {
-		fprintf(file, "Backtrace:\n");
-#ifdef __OPTIMIZE__
-    	fprintf(file, "  (Due to compiler optimizations, locations may not exactly match the source code)\n");
+static ExceptionBacktracePolicy *ExceptionBacktrace_get_policy(const ExceptionType *type) {
+	int count = __atomic_load_n(&policy_count, __ATOMIC_ACQUIRE);
+	if (count == 0)
+		return &default_policy;
+
+	// The nearest ancestor with a policy wins
+	while (type) {
+		for (int i = 0; i < count; i++)
+			if (policies[i].type == type)
+				return &policies[i];
+		if (type == type->super)
+			break;
+		type = type->super;
+	}
+	return &default_policy;
+}
+
+void ExceptionBacktrace_initialize() {
+#ifdef EXCEPTIONAL_BACKTRACE_FRAME_POINTERS
+	if (stack_high)
+		return;
+	pthread_attr_t attr;
+	if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+		void *address;
+		size_t size;
+		if (pthread_attr_getstack(&attr, &address, &size) == 0) {
+			stack_low = address;
+			stack_high = stack_low + size;
+		}
+		pthread_attr_destroy(&attr);
+	}
+#else
+	// The first call loads libgcc_s and initializes its unwinder, which can take milliseconds
+	void *frames[1];
+	backtrace(frames, 1);
 #endif
-		for (int i = self->skip, size = self->size; i < size; i++) {
-			fprintf(file, "  %s\n", strings[i]);
-			addr2line(self->frames[i], file);
+}
+
+#ifdef EXCEPTIONAL_BACKTRACE_FRAME_POINTERS
+
+/*
+ * Each frame starts with the caller's frame pointer followed by the return address
+ * (true for x86-64 and AArch64). Stops at the first frame pointer that isn't inside our
+ * stack, isn't aligned, or doesn't move up the stack.
+ */
+static int ExceptionBacktrace_walk(void **fp, void **frames, int size) {
+	if (!stack_high)
+		ExceptionBacktrace_initialize();
+
+	int count = 0;
+	while (count < size) {
+		if (((char *) fp < stack_low) || ((char *) (fp + 2) > stack_high) || ((uintptr_t) fp % sizeof(void *)))
+			break;
+		void *return_address = fp[1];
+		if (!return_address)
+			break;
+		frames[count++] = return_address;
+		void **next = fp[0];
+		if (next <= fp)
+			break;
+		fp = next;
+	}
+	return count;
+}
+
+#endif
+
+//
+// Store
+//
+
+/*
+ * Backtraces are interned: each distinct one is stored once, for the life of the
+ * process, in a hash table of push-only lists. So exceptions can share them without
+ * reference counting, and lookups need no locks.
+ */
+static ExceptionBacktrace *store[EXCEPTIONAL_BACKTRACE_STORE_BUCKETS];
+
+static uint64_t ExceptionBacktrace_hash(void **frames, int size) {
+	uint64_t hash = 0x9e3779b97f4a7c15ULL ^ (uint64_t) size;
+	for (int i = 0; i < size; i++) {
+		hash ^= (uint64_t) (uintptr_t) frames[i];
+		hash *= 0xff51afd7ed558ccdULL;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+static ExceptionBacktrace *ExceptionBacktrace_find(ExceptionBacktrace *entry, ExceptionBacktrace *until, uint64_t hash, void **frames, int size) {
+	for (; entry != until; entry = __atomic_load_n(&entry->next, __ATOMIC_ACQUIRE))
+		if ((entry->hash == hash) && (entry->size == size) && !memcmp(entry->frames, frames, size * sizeof(void *)))
+			return entry;
+	return NULL;
+}
+
+static const ExceptionBacktrace *ExceptionBacktrace_intern(void **frames, int size) {
+	uint64_t hash = ExceptionBacktrace_hash(frames, size);
+	ExceptionBacktrace **bucket = &store[hash % EXCEPTIONAL_BACKTRACE_STORE_BUCKETS];
+
+	ExceptionBacktrace *head = __atomic_load_n(bucket, __ATOMIC_ACQUIRE);
+	ExceptionBacktrace *found = ExceptionBacktrace_find(head, NULL, hash, frames, size);
+	if (found)
+		return found;
+
+	ExceptionBacktrace *entry = malloc(sizeof(ExceptionBacktrace) + size * sizeof(void *));
+	entry->hash = hash;
+	entry->size = size;
+	memcpy(entry->frames, frames, size * sizeof(void *));
+	while (true) {
+		entry->next = head;
+		ExceptionBacktrace *seen = head;
+		if (__atomic_compare_exchange_n(bucket, &head, entry, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+			return entry;
+		// Someone else pushed in the meantime: maybe the same backtrace
+		found = ExceptionBacktrace_find(head, seen, hash, frames, size);
+		if (found) {
+			free(entry);
+			return found;
 		}
-		free(strings);
 	}
 }
 
-#define MAX_EXE_NAME_SIZE 1024
-#define MAX_COMMAND_SIZE 1024
-#define MAX_LINE_SIZE 1024
-
-static bool addr2line(void *line, FILE *file) {
-    // See: http://stackoverflow.com/a/4611112/849021
-	char exe_name[MAX_EXE_NAME_SIZE];
-	if (!get_exe_name(getpid(), exe_name, sizeof(exe_name)))
-		return false;
-
-	char command[MAX_COMMAND_SIZE];
-	char *escaped_exe_name = exceptional_escape_spaces(exe_name);
-	sprintf(command, "/usr/bin/addr2line %p -p -f -i -e %s", line, escaped_exe_name);
-	free(escaped_exe_name);
-
-	FILE *f = popen(command, "r");
-	if (!f)
-		return false;
-
-	char data[MAX_LINE_SIZE];
-	while (fgets(data, sizeof(data), f))
-		fprintf(file, "  > %s", data);
-	return pclose(f) != -1;
+const ExceptionBacktrace *ExceptionBacktrace_create(const ExceptionType *type) {
+	ExceptionBacktracePolicy *policy = ExceptionBacktrace_get_policy(type);
+	unsigned int sample_rate = __atomic_load_n(&policy->sample_rate, __ATOMIC_RELAXED);
+	if (sample_rate == 0)
+		return NULL;
+	if ((sample_rate > 1) && (__atomic_fetch_add(&policy->counter, 1, __ATOMIC_RELAXED) % sample_rate))
+		return NULL;
+
+	// Our own frames and Exception_new's are captured, but not stored
+	const int skip = OWN_FRAMES + 1;
+	int size = __atomic_load_n(&policy->max_depth, __ATOMIC_RELAXED);
+	if ((size == 0) || (size > EXCEPTION_MAX_BACKTRACE_SIZE))
+		size = EXCEPTION_MAX_BACKTRACE_SIZE;
+	void *frames[EXCEPTION_MAX_BACKTRACE_SIZE + OWN_FRAMES + 1];
+#ifdef EXCEPTIONAL_BACKTRACE_FRAME_POINTERS
+	// Our frame holds the return address into our caller
+	size = ExceptionBacktrace_walk(__builtin_frame_address(0), frames, size + skip);
+#else
+	size = backtrace(frames, size + skip);
+#endif
+
+	return size > skip ? ExceptionBacktrace_intern(frames + skip, size - skip) : NULL;
 }
 
-#define MAX_LINK_SIZE 1024
-
-static bool get_exe_name(__pid_t pid, char *exe_name, size_t exe_name_size) {
-	char link[MAX_LINK_SIZE];
-	if (snprintf(link, sizeof(link), "/proc/%d/exe", pid) < 0)
-		return false;
-	size_t r = readlink(link, exe_name, exe_name_size - 1);
-	if (r == -1)
-		return false;
-	exe_name[r] = 0; // readlink doesn't add terminating null
-	return true;
+void ExceptionBacktrace_dump(const ExceptionBacktrace *self, FILE *file) {
+	fprintf(file, "Backtrace:\n");
+#ifdef __OPTIMIZE__
+	fprintf(file, "  (Due to compiler optimizations, locations may not exactly match the source code)\n");
+#endif
+	for (int i = 0, size = self->size; i < size; i++) {
+		ExceptionSymbol symbol;
+		if (!ExceptionSymbolizer_symbolize(self->frames[i], &symbol)) {
+			fprintf(file, "  [%p]\n", self->frames[i]);
+			continue;
+		}
+		fprintf(file, "  %s(%s+0x%zx) [%p]\n", symbol.object, symbol.function ? symbol.function : "", symbol.offset, self->frames[i]);
+		if (symbol.file)
+			fprintf(file, "  > %s at %s:%d\n", symbol.function ? symbol.function : "??", symbol.file, symbol.line);
+	}
 }
 
 #endif
@@ -9,17 +9,40 @@ void ExceptionFrame_dump(ExceptionFrame *self, FILE *file) {
 }
 
 void ExceptionContext_create(ExceptionContext *self) {
-	list_init(&self->frames);
-	list_init(&self->exceptions);
-	self->valid = true;
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	self->current_frame = NULL;
+#else
+	self->frames = NULL;
+	self->frame_count = 0;
+	self->frame_capacity = 0;
+#endif
+	ExceptionQueue_create(&self->exceptions);
 }
 
 void ExceptionContext_destroy(ExceptionContext *self) {
-	self->valid = false;
-	if (exceptional_list_destroy_with_elements(&self->frames, NULL))
-		self->frames = (list_t) {0};
-	if (exceptional_list_destroy_with_elements(&self->exceptions, (exceptional_list_destroy_element_fn) Exception_destroy))
-		self->exceptions = (list_t) {0};
+	// Contexts that were never used (the common case for local scopes) have nothing to free
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	self->current_frame = NULL;
+#else
+	if (self->frames) {
+		free(self->frames);
+		self->frames = NULL;
+		self->frame_count = 0;
+		self->frame_capacity = 0;
+	}
+#endif
+	if (self->exceptions.head)
+		ExceptionQueue_destroy(&self->exceptions);
+}
+
+void ExceptionContext_reset(ExceptionContext *self) {
+	// Like destroy, but we keep the frame storage for reuse
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	self->current_frame = NULL;
+#else
+	self->frame_count = 0;
+#endif
+	ExceptionQueue_destroy(&self->exceptions);
 }
 
 void ExceptionContext_destroy_and_free(ExceptionContext *context) {
@@ -29,81 +52,125 @@ void ExceptionContext_destroy_and_free(ExceptionContext *context) {
 
 // Frames
 
-void ExceptionContext_push_frame(ExceptionContext *self, jmp_buf *jmp, JumpReason finally_jump_reason, bool trying, bool rethrowing, const char *keyword, const char *file, int line, const char *fn) {
-	ExceptionFrame *frame = malloc(sizeof(ExceptionFrame));
-	memcpy(frame->jmp, jmp, sizeof(jmp_buf));
-	frame->finally_jump_reason = finally_jump_reason;
-	frame->trying = trying;
-	frame->rethrowing = rethrowing;
-	frame->keyword = keyword;
-	frame->location.file = file;
-	frame->location.line = line;
-	frame->location.fn = fn;
-	list_prepend(&self->frames, frame);
+#ifdef EXCEPTIONAL_JUMP_UNWIND
+
+#define EXCEPTIONAL_UNWIND_CLASS 0x54414C4543455843ULL // "TALECEXC"
+
+static void ExceptionContext_unwind_cleanup(_Unwind_Reason_Code reason, struct _Unwind_Exception *exception) {
+	// The exception object lives in the context, so there is nothing to free
 }
 
-void ExceptionContext_pop_frame(ExceptionContext *self) {
-	ExceptionFrame *frame = list_fetch(&self->frames);
-	if (frame) {
-		JumpReason finally_jump_reason = frame->finally_jump_reason;
-		free(frame);
-		// Maintain the reason on the last frame
-		frame = list_get_at(&self->frames, 0);
-		if (frame)
-			frame->finally_jump_reason = finally_jump_reason;
-	}
+static _Unwind_Reason_Code ExceptionContext_unwind_stop(int version, _Unwind_Action actions, _Unwind_Exception_Class exception_class, struct _Unwind_Exception *exception, struct _Unwind_Context *unwind_context, void *parameter) {
+	ExceptionContext *self = parameter;
+
+	// Frames below the jump point's frame have their CFA at or below the jump buffer
+	if ((actions & _UA_END_OF_STACK) || (_Unwind_GetCFA(unwind_context) > (_Unwind_Word) self->unwind_origin))
+		__builtin_longjmp(self->unwind_jmp, 1);
+
+	// Keep unwinding (this will run cleanups in this frame)
+	return _URC_NO_REASON;
 }
 
-ExceptionFrame *ExceptionContext_get_current_frame(ExceptionContext *self) {
-	return list_get_at(&self->frames, 0);
+#endif
+
+#if defined(EXCEPTIONAL_JUMP_UNWIND) || defined(EXCEPTIONAL_JUMP_BUILTIN)
+
+void ExceptionContext_jump_point() {
+	// Only its "returns_twice" attribute matters (see EXCEPTIONAL_JUMP_POINT)
 }
 
-void ExceptionContext_jump(ExceptionContext *self) {
-	ExceptionFrame *frame = list_fetch(&self->frames);
+#endif
+
+static void ExceptionContext_long_jump(ExceptionContext *self, ExceptionFrame *frame, JumpReason reason) {
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	ExceptionJumpBuffer *jmp = frame->jmp;
+#else
+	ExceptionJumpBuffer *jmp = &frame->jmp;
+#endif
+
+#if defined(EXCEPTIONAL_JUMP_UNWIND)
+	// The frame might be reused by cleanups while unwinding, so we copy what we need
+	self->jump_reason = reason;
+	memcpy(self->unwind_jmp, jmp, sizeof(ExceptionJumpBuffer));
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	self->unwind_origin = frame->jmp;
+#else
+	self->unwind_origin = frame->origin;
+#endif
+	self->unwind_exception.exception_class = EXCEPTIONAL_UNWIND_CLASS;
+	self->unwind_exception.exception_cleanup = ExceptionContext_unwind_cleanup;
+	_Unwind_ForcedUnwind(&self->unwind_exception, ExceptionContext_unwind_stop, self);
+	abort(); // not supposed to get here
+#elif defined(EXCEPTIONAL_JUMP_BUILTIN)
+	// __builtin_longjmp can only deliver 1, so the reason is read back from the context
+	self->jump_reason = reason;
+	__builtin_longjmp(*jmp, 1);
+#else
+	longjmp(*jmp, reason);
+#endif
+}
+
+#ifdef EXCEPTIONAL_STACK_FRAMES
 
+void ExceptionContext_jump(ExceptionContext *self) {
+	ExceptionFrame *frame = self->current_frame;
 	if (frame) {
-		JumpReason finally_jump_reason = frame->finally_jump_reason;
-		if (finally_jump_reason) {
-			jmp_buf jmp;
-			memcpy(jmp, frame->jmp, sizeof(jmp_buf));
-			free(frame);
-			longjmp(jmp, finally_jump_reason);
-		}
-		else
-			free(frame);
+		self->current_frame = frame->previous;
+		if (frame->finally_jump_reason)
+			ExceptionContext_long_jump(self, frame, frame->finally_jump_reason);
 	}
 }
 
 void ExceptionContext_jump_because(ExceptionContext *self, JumpReason reason) {
-	ExceptionFrame *frame = list_fetch(&self->frames);
-
+	ExceptionFrame *frame = self->current_frame;
 	if (frame) {
-		if (reason) {
-			jmp_buf jmp;
-			memcpy(jmp, frame->jmp, sizeof(jmp_buf));
-			free(frame);
-			longjmp(jmp, reason);
-		}
-		else
-			free(frame);
+		self->current_frame = frame->previous;
+		if (reason)
+			ExceptionContext_long_jump(self, frame, reason);
+	}
+}
+
+#else
+
+void ExceptionContext_grow_frames(ExceptionContext *self) {
+	int capacity = self->frame_capacity ? self->frame_capacity * 2 : EXCEPTIONAL_INITIAL_FRAMES;
+	ExceptionFrame *frames = realloc(self->frames, capacity * sizeof(ExceptionFrame));
+	if (!frames) {
+		// The keyword can't run without its frame, and has no way to report the failure, so
+		// we stop here rather than lose the frames we have
+		fprintf(stderr, "exceptional: could not grow the frame stack to %d frames\n", capacity);
+		abort();
 	}
+	self->frames = frames;
+	self->frame_capacity = capacity;
 }
 
-bool ExceptionContext_is_trying(ExceptionContext *self) {
-	ExceptionFrame *frame = list_get_at(&self->frames, 0);
-	if (frame)
-		return frame->trying;
-	return false;
+void ExceptionContext_jump(ExceptionContext *self) {
+	if (self->frame_count) {
+		// The popped frame's storage stays valid: the stack never shrinks
+		ExceptionFrame *frame = &self->frames[--self->frame_count];
+		if (frame->finally_jump_reason)
+			ExceptionContext_long_jump(self, frame, frame->finally_jump_reason);
+	}
 }
 
-void ExceptionContext_stop_trying(ExceptionContext *self) {
-	ExceptionFrame *frame = list_get_at(&self->frames, 0);
-	if (frame)
-		frame->trying = false;
+void ExceptionContext_jump_because(ExceptionContext *self, JumpReason reason) {
+	if (self->frame_count) {
+		ExceptionFrame *frame = &self->frames[--self->frame_count];
+		if (reason)
+			ExceptionContext_long_jump(self, frame, reason);
+	}
 }
 
+#endif
+
 void ExceptionContext_dump_frames(ExceptionContext *self, FILE *file) {
-	exceptional_list_for_each (&self->frames, ExceptionFrame, frame) {
+#ifdef EXCEPTIONAL_STACK_FRAMES
+	for (ExceptionFrame *frame = self->current_frame; frame; frame = frame->previous) {
+#else
+	for (int i = self->frame_count - 1; i >= 0; i--) {
+		ExceptionFrame *frame = &self->frames[i];
+#endif
 		fprintf(file, ANSI_COLOR_BRIGHT_BLUE "  > ");
 		ExceptionFrame_dump(frame, file);
 		fprintf(file, ANSI_COLOR_RESET);
@@ -113,50 +180,39 @@ void ExceptionContext_dump_frames(ExceptionContext *self, FILE *file) {
 // Exceptions
 
 void ExceptionContext_add_exception(ExceptionContext *self, Exception *exception) {
-	list_append(&self->exceptions, exception);
+	ExceptionQueue_append(&self->exceptions, exception);
 }
 
 Exception *ExceptionContext_fetch_exception(ExceptionContext *self, const ExceptionType *type) {
-	Exception *found_exception = NULL;
-
-	// Find a matching exception
-	exceptional_list_for_each (&self->exceptions, Exception, exception)
-		if (ExceptionType_is_a(exception->type, type)) {
-			found_exception = exception;
-			break;
-		}
-
-	if (found_exception)
-		list_delete(&self->exceptions, found_exception);
+	// Find a matching exception and unlink it where it is
+	Exception *previous = NULL;
+	exceptional_queue_for_each (&self->exceptions, exception) {
+		if (ExceptionType_is_a(exception->type, type))
+			return ExceptionQueue_remove(&self->exceptions, previous);
+		previous = exception;
+	}
 
-	return found_exception;
+	return NULL;
 }
 
 bool ExceptionContext_has_exceptions(ExceptionContext *self) {
-	return !list_empty(&self->exceptions);
+	return self->exceptions.head != NULL;
 }
 
 void ExceptionContext_clear_exceptions(ExceptionContext *self, bool except_first) {
-	if (list_empty(&self->exceptions))
+	if (self->exceptions.count <= (except_first ? 1 : 0))
 		return;
 
-	Exception *first = NULL;
-	if (except_first) {
-		if (list_size(&self->exceptions) == 1)
-			return;
-		first = list_fetch(&self->exceptions);
-	}
+	Exception *first = except_first ? ExceptionQueue_remove(&self->exceptions, NULL) : NULL;
 
-	exceptional_list_for_each (&self->exceptions, Exception, exception)
-		Exception_destroy_and_free(exception);
-	list_clear(&self->exceptions);
+	ExceptionQueue_destroy(&self->exceptions);
 
 	if (first)
-		list_append(&self->exceptions, first);
+		ExceptionQueue_append(&self->exceptions, first);
 }
 
 void ExceptionContext_dump_exceptions(ExceptionContext *self, FILE *file) {
-	exceptional_list_for_each (&self->exceptions, Exception, exception) {
+	exceptional_queue_for_each (&self->exceptions, exception) {
 		fprintf(file, ANSI_COLOR_BRIGHT_RED "  ! ");
 		Exception_dump(exception, file, EXCEPTION_DUMP_LONG);
 		fprintf(file, ANSI_COLOR_RESET);
@@ -165,27 +221,28 @@ void ExceptionContext_dump_exceptions(ExceptionContext *self, FILE *file) {
 
 // Helpers
 
-void ExceptionContext_try(ExceptionContext *self, jmp_buf *jmp, JumpReason reason, const char *file, int line, const char *fn) {
+void ExceptionContext_try_slow(ExceptionContext *self, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *file, int line, const char *fn) {
+	// (The debug output names the inline keyword functions, which is what users see)
 	if (reason) {
 		// We've jumped here!
 
 		if (reason == JUMP_REASON_THROW)
 			// Re-insert the "try" jump point: an exception might be thrown again in "finally"
-			ExceptionContext_push_frame(self, jmp, JUMP_REASON_THROW, false, false, "try/throw", file, line, fn);
+			ExceptionContext_push_frame(self, frame, jmp, JUMP_REASON_THROW, false, false, "try/throw", file, line, fn);
 		else if (reason == JUMP_REASON_RETHROW)
 			// Re-insert the "try" jump point: an exception might be thrown again in "finally"
-			ExceptionContext_push_frame(self, jmp, JUMP_REASON_THROW, false, true, "try/rethrow", file, line, fn);
+			ExceptionContext_push_frame(self, frame, jmp, JUMP_REASON_THROW, false, true, "try/rethrow", file, line, fn);
 
 		// Make sure we have no more than one exception
 		ExceptionContext_clear_exceptions(self, true);
 
-		if (exceptional_debug) {
+		if (EXCEPTIONAL_DEBUGGING) {
 			if (reason == JUMP_REASON_THROW)
-				exceptional_dump_fn(exceptional_debug, __FUNCTION__, "thrown", NULL);
+				exceptional_dump_fn(exceptional_debug, "ExceptionContext_try", "thrown", NULL);
 			else if (reason == JUMP_REASON_RETHROW)
-				exceptional_dump_fn(exceptional_debug, __FUNCTION__, "rethrown", NULL);
+				exceptional_dump_fn(exceptional_debug, "ExceptionContext_try", "rethrown", NULL);
 			else
-				exceptional_dump_fn(exceptional_debug, __FUNCTION__, "end", NULL);
+				exceptional_dump_fn(exceptional_debug, "ExceptionContext_try", "end", NULL);
 			ExceptionContext_dump_exceptions(self, exceptional_debug);
 			ExceptionContext_dump_frames(self, exceptional_debug);
 		}
@@ -193,10 +250,10 @@ void ExceptionContext_try(ExceptionContext *self, jmp_buf *jmp, JumpReason reaso
 	else {
 		// All we did was set the jump point
 
-		ExceptionContext_push_frame(self, jmp, JUMP_REASON_DONT, true, false, "try", file, line, fn);
+		ExceptionContext_push_frame(self, frame, jmp, JUMP_REASON_DONT, true, false, "try", file, line, fn);
 
-		if (exceptional_debug) {
-			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "begin", NULL);
+		if (EXCEPTIONAL_DEBUGGING) {
+			exceptional_dump_fn(exceptional_debug, "ExceptionContext_try", "begin", NULL);
 			ExceptionContext_dump_exceptions(self, exceptional_debug);
 			ExceptionContext_dump_frames(self, exceptional_debug);
 		}
@@ -206,7 +263,7 @@ void ExceptionContext_try(ExceptionContext *self, jmp_buf *jmp, JumpReason reaso
 void ExceptionContext_throw(ExceptionContext *self, Exception *exception) {
 	ExceptionContext_add_exception(self, exception);
 
-	if (exceptional_debug) {
+	if (EXCEPTIONAL_DEBUGGING) {
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, exception->type->name);
 		ExceptionContext_dump_exceptions(self, exceptional_debug);
 		ExceptionContext_dump_frames(self, exceptional_debug);
@@ -219,7 +276,7 @@ void ExceptionContext_throw(ExceptionContext *self, Exception *exception) {
 		ExceptionContext_jump_because(self, JUMP_REASON_THROW);
 }
 
-Exception *ExceptionContext_catch(ExceptionContext *self, const ExceptionType *type) {
+Exception *ExceptionContext_catch_slow(ExceptionContext *self, const ExceptionType *type) {
 	ExceptionFrame *frame = ExceptionContext_get_current_frame(self);
 	if (frame && frame->rethrowing)
 		// Don't catch when an exception is rethrowm
@@ -234,11 +291,11 @@ Exception *ExceptionContext_catch(ExceptionContext *self, const ExceptionType *t
 		}
 	}
 
-	if (exceptional_debug) {
+	if (EXCEPTIONAL_DEBUGGING) {
 		if (exception)
-			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "hit", type->name);
+			exceptional_dump_fn(exceptional_debug, "ExceptionContext_catch", "hit", type->name);
 		else
-			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "miss", type->name);
+			exceptional_dump_fn(exceptional_debug, "ExceptionContext_catch", "miss", type->name);
 		ExceptionContext_dump_exceptions(self, exceptional_debug);
 		ExceptionContext_dump_frames(self, exceptional_debug);
 	}
@@ -246,8 +303,54 @@ Exception *ExceptionContext_catch(ExceptionContext *self, const ExceptionType *t
 	return exception;
 }
 
+Exception *ExceptionContext_catch_any(ExceptionContext *self, const ExceptionType **types, int *index) {
+	ExceptionFrame *frame = ExceptionContext_get_current_frame(self);
+	if (frame && frame->rethrowing)
+		// Don't catch when an exception is rethrowm
+		return NULL;
+
+	// Find the first matching exception, and the most specific type it matches
+	Exception *found_exception = NULL, *previous = NULL;
+	int found_index = -1;
+	exceptional_queue_for_each (&self->exceptions, exception) {
+		for (int i = 0; types[i]; i++)
+			if (ExceptionType_is_a(exception->type, types[i])) {
+				// All the matched types are ancestors of the exception type, so the most specific
+				// one is a descendant of all others
+				if ((found_index == -1) || ((types[i] != types[found_index]) && ExceptionType_is_a(types[i], types[found_index])))
+					found_index = i;
+			}
+		if (found_index != -1) {
+			found_exception = exception;
+			break;
+		}
+		previous = exception;
+	}
+
+	if (found_exception) {
+		ExceptionQueue_remove(&self->exceptions, previous);
+		// The exception was caught
+		if (frame) {
+			frame->finally_jump_reason = JUMP_REASON_DONT;
+			frame->rethrowing = true;
+		}
+	}
+
+	if (EXCEPTIONAL_DEBUGGING) {
+		if (found_exception)
+			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "hit", types[found_index]->name);
+		else
+			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "miss", NULL);
+		ExceptionContext_dump_exceptions(self, exceptional_debug);
+		ExceptionContext_dump_frames(self, exceptional_debug);
+	}
+
+	*index = found_index;
+	return found_exception;
+}
+
 void ExceptionContext_catch_done(ExceptionContext *self, Exception *exception) {
-	if (exceptional_debug) {
+	if (EXCEPTIONAL_DEBUGGING) {
 		if (exception)
 			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "hit", exception->type->name);
 		else
@@ -260,19 +363,19 @@ void ExceptionContext_catch_done(ExceptionContext *self, Exception *exception) {
 		Exception_destroy_and_free(exception);
 }
 
-void ExceptionContext_finally_done(ExceptionContext *self) {
+void ExceptionContext_finally_done_slow(ExceptionContext *self) {
 	ExceptionFrame *frame = ExceptionContext_get_current_frame(self);
 	if (frame && (frame->finally_jump_reason != JUMP_REASON_DONT)) {
 		// Unwinding, so we need to pop the current "try"
-		if (exceptional_debug) {
-			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "unwind", NULL);
+		if (EXCEPTIONAL_DEBUGGING) {
+			exceptional_dump_fn(exceptional_debug, "ExceptionContext_finally_done", "unwind", NULL);
 			ExceptionContext_dump_exceptions(self, exceptional_debug);
 			ExceptionContext_dump_frames(self, exceptional_debug);
 		}
 		ExceptionContext_pop_frame(self);
 	}
-	else if (exceptional_debug) {
-		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
+	else if (EXCEPTIONAL_DEBUGGING) {
+		exceptional_dump_fn(exceptional_debug, "ExceptionContext_finally_done", NULL, NULL);
 		ExceptionContext_dump_exceptions(self, exceptional_debug);
 		ExceptionContext_dump_frames(self, exceptional_debug);
 	}
@@ -282,9 +385,9 @@ void ExceptionContext_finally_done(ExceptionContext *self) {
 }
 
 int ExceptionContext_count_exceptions(ExceptionContext *self) {
-	return list_size(&self->exceptions);
+	return self->exceptions.count;
 }
 
 Exception *ExceptionContext_get_exception(ExceptionContext *self, int index) {
-	return list_get_at(&self->exceptions, index);
+	return ExceptionQueue_get(&self->exceptions, index);
 }
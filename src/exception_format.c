@@ -0,0 +1,278 @@
+#ifdef EXCEPTIONAL_DEFERRED_FORMAT
+
+#define _POSIX_C_SOURCE 200809L // for strnlen
+
+#include "exceptional.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Longest conversion specification we will re-create when rendering (after expanding "*")
+#define MAX_SPEC_SIZE 64
+
+typedef enum {
+	FORMAT_INVALID,
+	FORMAT_PERCENT,
+	FORMAT_INT,
+	FORMAT_LONG,
+	FORMAT_LONG_LONG,
+	FORMAT_INTMAX,
+	FORMAT_SIZE,
+	FORMAT_PTRDIFF,
+	FORMAT_DOUBLE,
+	FORMAT_LONG_DOUBLE,
+	FORMAT_POINTER,
+	FORMAT_STRING
+} ExceptionFormatKind;
+
+typedef struct ExceptionFormatSpec {
+	const char *start;
+	size_t length;
+	bool star_width;
+	bool star_precision;
+	int precision; // -1 if none (or given by "*")
+	ExceptionFormatKind kind;
+} ExceptionFormatSpec;
+
+/*
+ * Parses the conversion specification starting at "%". Returns the position after it.
+ */
+static const char *ExceptionFormat_parse(const char *p, ExceptionFormatSpec *spec) {
+	spec->start = p++;
+	spec->star_width = false;
+	spec->star_precision = false;
+	spec->precision = -1;
+	spec->kind = FORMAT_INVALID;
+
+	if (*p == '%') {
+		spec->kind = FORMAT_PERCENT;
+		spec->length = 2;
+		return p + 1;
+	}
+
+	while ((*p == '-') || (*p == '+') || (*p == ' ') || (*p == '#') || (*p == '0') || (*p == '\''))
+		p++;
+	if (*p == '*') {
+		spec->star_width = true;
+		p++;
+	}
+	else
+		while (*p >= '0' && *p <= '9')
+			p++;
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec->star_precision = true;
+			p++;
+		}
+		else {
+			// A lone "." means a precision of 0
+			spec->precision = 0;
+			while (*p >= '0' && *p <= '9') {
+				if (spec->precision < 1000000)
+					spec->precision = spec->precision * 10 + (*p - '0');
+				p++;
+			}
+		}
+	}
+
+	ExceptionFormatKind integer = FORMAT_INT;
+	bool long_double = false;
+	bool wide = false;
+	switch (*p) {
+	case 'h': p++; if (*p == 'h') p++; break;
+	case 'l': p++; if (*p == 'l') { integer = FORMAT_LONG_LONG; p++; } else { integer = FORMAT_LONG; wide = true; } break;
+	case 'j': integer = FORMAT_INTMAX; p++; break;
+	case 'z': integer = FORMAT_SIZE; p++; break;
+	case 't': integer = FORMAT_PTRDIFF; p++; break;
+	case 'L': long_double = true; p++; break;
+	}
+
+	switch (*p) {
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+		spec->kind = integer;
+		break;
+	case 'c':
+		if (!wide)
+			spec->kind = FORMAT_INT;
+		break;
+	case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+		spec->kind = long_double ? FORMAT_LONG_DOUBLE : FORMAT_DOUBLE;
+		break;
+	case 'p':
+		spec->kind = FORMAT_POINTER;
+		break;
+	case 's':
+		if (!wide)
+			spec->kind = FORMAT_STRING;
+		break;
+	}
+	// Anything else, including "%n", stays FORMAT_INVALID
+
+	if (*p)
+		p++;
+	spec->length = p - spec->start;
+	return p;
+}
+
+bool ExceptionFormat_capture(ExceptionFormat *self, const char *format, va_list args) {
+	if (!format)
+		return false;
+
+	// We only consume a copy, so that the caller can still use the arguments if we fail
+	va_list args_copy;
+	va_copy(args_copy, args);
+
+	ExceptionFormatSpec spec;
+	size_t string_sizes[EXCEPTIONAL_MAX_FORMAT_ARGUMENTS];
+	size_t strings_size = 0;
+	int count = 0;
+	for (const char *p = strchr(format, '%'); p; p = strchr(p, '%')) {
+		p = ExceptionFormat_parse(p, &spec);
+		if (spec.kind == FORMAT_PERCENT)
+			continue;
+		if ((spec.kind == FORMAT_INVALID) || (spec.length > MAX_SPEC_SIZE / 2)
+			|| (count + 1 + spec.star_width + spec.star_precision > EXCEPTIONAL_MAX_FORMAT_ARGUMENTS)) {
+			va_end(args_copy);
+			return false;
+		}
+
+		if (spec.star_width) {
+			string_sizes[count] = 0;
+			self->arguments[count++].i = va_arg(args_copy, int);
+		}
+		int precision = spec.precision;
+		if (spec.star_precision) {
+			string_sizes[count] = 0;
+			precision = self->arguments[count++].i = va_arg(args_copy, int);
+		}
+		ExceptionFormatArgument *argument = &self->arguments[count];
+		string_sizes[count++] = 0;
+		switch (spec.kind) {
+		case FORMAT_INT: argument->i = va_arg(args_copy, int); break;
+		case FORMAT_LONG: argument->l = va_arg(args_copy, long); break;
+		case FORMAT_LONG_LONG: argument->ll = va_arg(args_copy, long long); break;
+		case FORMAT_INTMAX: argument->j = va_arg(args_copy, intmax_t); break;
+		case FORMAT_SIZE: argument->z = va_arg(args_copy, size_t); break;
+		case FORMAT_PTRDIFF: argument->t = va_arg(args_copy, ptrdiff_t); break;
+		case FORMAT_DOUBLE: argument->d = va_arg(args_copy, double); break;
+		case FORMAT_LONG_DOUBLE: argument->ld = va_arg(args_copy, long double); break;
+		case FORMAT_POINTER: argument->p = va_arg(args_copy, void *); break;
+		case FORMAT_STRING:
+			argument->s = va_arg(args_copy, char *);
+			if (argument->s) {
+				// With a precision, the string need not be terminated, so we must not read past it
+				// (a negative "*" precision means none)
+				string_sizes[count - 1] = (precision >= 0 ? strnlen(argument->s, precision) : strlen(argument->s)) + 1;
+				strings_size += string_sizes[count - 1];
+			}
+			break;
+		default: break;
+		}
+	}
+	va_end(args_copy);
+
+	self->format = format;
+	self->argument_count = count;
+
+	// The strings might not live as long as the exception, so we keep copies of them all in one block
+	if (strings_size <= EXCEPTIONAL_INLINE_MESSAGE_SIZE) {
+		self->strings = self->inline_strings;
+		self->own_strings = false;
+	}
+	else {
+		self->strings = malloc(strings_size);
+		self->own_strings = true;
+	}
+	char *string = self->strings;
+	for (int i = 0; i < count; i++)
+		if (string_sizes[i]) {
+			memcpy(string, self->arguments[i].s, string_sizes[i] - 1);
+			string[string_sizes[i] - 1] = '\0';
+			self->arguments[i].s = string;
+			string += string_sizes[i];
+		}
+
+	return true;
+}
+
+/*
+ * Like snprintf into the remainder of the buffer, but keeps counting after it is full.
+ */
+#define APPEND(FORMAT, ...) \
+	{ \
+		int appended = snprintf(length < size ? buffer + length : NULL, length < size ? size - length : 0, FORMAT, __VA_ARGS__); \
+		if (appended > 0) \
+			length += appended; \
+	}
+
+int ExceptionFormat_render(ExceptionFormat *self, char *buffer, size_t size) {
+	size_t length = 0;
+	ExceptionFormatArgument *argument = self->arguments;
+	ExceptionFormatSpec spec;
+
+	const char *p = self->format;
+	while (*p) {
+		const char *percent = strchr(p, '%');
+		size_t literal = percent ? (size_t) (percent - p) : strlen(p);
+		if (literal) {
+			APPEND("%.*s", (int) literal, p);
+			p += literal;
+		}
+		if (!percent)
+			break;
+
+		p = ExceptionFormat_parse(percent, &spec);
+		if (spec.kind == FORMAT_PERCENT) {
+			APPEND("%s", "%");
+			continue;
+		}
+
+		// Re-create the specification with the captured "*" values written in
+		char spec_format[MAX_SPEC_SIZE];
+		char *s = spec_format;
+		for (const char *c = spec.start; c < spec.start + spec.length; c++) {
+			if ((*c == '*') && (c[-1] == '.')) {
+				int precision = (argument++)->i;
+				if (precision >= 0)
+					s += sprintf(s, "%d", precision);
+				else
+					// A negative precision means no precision
+					s--;
+			}
+			else if (*c == '*')
+				s += sprintf(s, "%d", (argument++)->i);
+			else
+				*s++ = *c;
+		}
+		*s = '\0';
+
+		switch (spec.kind) {
+		case FORMAT_INT: APPEND(spec_format, argument->i); break;
+		case FORMAT_LONG: APPEND(spec_format, argument->l); break;
+		case FORMAT_LONG_LONG: APPEND(spec_format, argument->ll); break;
+		case FORMAT_INTMAX: APPEND(spec_format, argument->j); break;
+		case FORMAT_SIZE: APPEND(spec_format, argument->z); break;
+		case FORMAT_PTRDIFF: APPEND(spec_format, argument->t); break;
+		case FORMAT_DOUBLE: APPEND(spec_format, argument->d); break;
+		case FORMAT_LONG_DOUBLE: APPEND(spec_format, argument->ld); break;
+		case FORMAT_POINTER: APPEND(spec_format, argument->p); break;
+		case FORMAT_STRING: APPEND(spec_format, argument->s); break;
+		default: break;
+		}
+		argument++;
+	}
+
+	if (size)
+		buffer[length < size ? length : size - 1] = '\0';
+	return (int) length;
+}
+
+void ExceptionFormat_destroy(ExceptionFormat *self) {
+	if (self->own_strings && self->strings) {
+		free(self->strings);
+		self->strings = NULL;
+	}
+	self->format = NULL;
+}
+
+#endif
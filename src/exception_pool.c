@@ -0,0 +1,102 @@
+#include "exceptional.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+struct ExceptionPool;
+
+typedef struct ExceptionRecord {
+	Exception exception; // must be first
+	struct ExceptionPool *pool;
+	struct ExceptionRecord *next_free;
+} ExceptionRecord;
+
+typedef struct ExceptionPool {
+	ExceptionRecord *free;        // only touched by the owning thread
+	ExceptionRecord *remote_free; // pushed to atomically by other threads
+	struct ExceptionPool *next_orphan;
+} ExceptionPool;
+
+static __thread ExceptionPool *exception_pool = NULL;
+
+// Pools of exited threads, waiting to be adopted by new threads
+static ExceptionPool *exception_pool_orphans = NULL;
+static pthread_mutex_t exception_pool_orphans_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_key_t exception_pool_key;
+static pthread_once_t exception_pool_key_once = PTHREAD_ONCE_INIT;
+
+static void ExceptionPool_orphan(ExceptionPool *self) {
+	// From now on, even this thread must free records into the pool remotely
+	exception_pool = NULL;
+
+	// Records may still be alive in other threads, so we can never free the pool
+	pthread_mutex_lock(&exception_pool_orphans_mutex);
+	self->next_orphan = exception_pool_orphans;
+	exception_pool_orphans = self;
+	pthread_mutex_unlock(&exception_pool_orphans_mutex);
+}
+
+static void ExceptionPool_create_key() {
+	pthread_key_create(&exception_pool_key, (void (*)(void *)) ExceptionPool_orphan);
+}
+
+static ExceptionPool *ExceptionPool_get() {
+	if (exception_pool)
+		return exception_pool;
+
+	pthread_mutex_lock(&exception_pool_orphans_mutex);
+	ExceptionPool *pool = exception_pool_orphans;
+	if (pool)
+		exception_pool_orphans = pool->next_orphan;
+	pthread_mutex_unlock(&exception_pool_orphans_mutex);
+
+	if (!pool)
+		pool = calloc(1, sizeof(ExceptionPool));
+
+	pthread_once(&exception_pool_key_once, ExceptionPool_create_key);
+	pthread_setspecific(exception_pool_key, pool);
+	exception_pool = pool;
+	return pool;
+}
+
+static void ExceptionPool_grow(ExceptionPool *self) {
+	// Reclaim records freed by other threads
+	self->free = __atomic_exchange_n(&self->remote_free, NULL, __ATOMIC_ACQUIRE);
+	if (self->free)
+		return;
+
+	// Slabs are never freed: the pool stays as large as its peak usage
+	ExceptionRecord *slab = malloc(EXCEPTIONAL_POOL_SLAB_SIZE * sizeof(ExceptionRecord));
+	for (int i = 0; i < EXCEPTIONAL_POOL_SLAB_SIZE; i++) {
+		slab[i].pool = self;
+		slab[i].next_free = i + 1 < EXCEPTIONAL_POOL_SLAB_SIZE ? &slab[i + 1] : NULL;
+	}
+	self->free = slab;
+}
+
+Exception *ExceptionPool_allocate() {
+	ExceptionPool *pool = ExceptionPool_get();
+	if (!pool->free)
+		ExceptionPool_grow(pool);
+
+	ExceptionRecord *record = pool->free;
+	pool->free = record->next_free;
+	return &record->exception;
+}
+
+void ExceptionPool_free(Exception *exception) {
+	ExceptionRecord *record = (ExceptionRecord *) exception;
+	ExceptionPool *pool = record->pool;
+
+	if (pool == exception_pool) {
+		record->next_free = pool->free;
+		pool->free = record;
+	}
+	else {
+		// Lock-free push: the owner takes the whole stack at once, so there is no ABA problem
+		ExceptionRecord *head = __atomic_load_n(&pool->remote_free, __ATOMIC_RELAXED);
+		do
+			record->next_free = head;
+		while (!__atomic_compare_exchange_n(&pool->remote_free, &head, record, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	}
+}
@@ -0,0 +1,110 @@
+#include "exceptional.h"
+#include <stddef.h>
+
+void ExceptionQueue_create(ExceptionQueue *self) {
+	self->head = NULL;
+	self->tail = NULL;
+	self->count = 0;
+}
+
+void ExceptionQueue_destroy(ExceptionQueue *self) {
+	Exception *exception = self->head;
+	while (exception) {
+		Exception *next = exception->next;
+		Exception_destroy_and_free(exception);
+		exception = next;
+	}
+	ExceptionQueue_create(self);
+}
+
+void ExceptionQueue_append(ExceptionQueue *self, Exception *exception) {
+	exception->next = NULL;
+	if (self->tail)
+		self->tail->next = exception;
+	else
+		self->head = exception;
+	self->tail = exception;
+	self->count++;
+}
+
+void ExceptionQueue_splice(ExceptionQueue *self, ExceptionQueue *source) {
+	// Relaying between two scopes of the same context is a no-op
+	if ((source == self) || !source->head)
+		return;
+
+	if (self->tail)
+		self->tail->next = source->head;
+	else
+		self->head = source->head;
+	self->tail = source->tail;
+	self->count += source->count;
+
+	ExceptionQueue_create(source);
+}
+
+Exception *ExceptionQueue_remove(ExceptionQueue *self, Exception *previous) {
+	Exception *exception = previous ? previous->next : self->head;
+	if (!exception)
+		return NULL;
+
+	if (previous)
+		previous->next = exception->next;
+	else
+		self->head = exception->next;
+	if (self->tail == exception)
+		self->tail = previous;
+	self->count--;
+
+	exception->next = NULL;
+	return exception;
+}
+
+void ExceptionQueue_push_stack(ExceptionQueue *self, Exception **stack) {
+	if (!self->head)
+		return;
+
+	// The stack is newest first, so we reverse our chain before pushing it, and the taker
+	// reverses everything back
+	Exception *reversed = NULL;
+	for (Exception *exception = self->head, *next; exception; exception = next) {
+		next = exception->next;
+		exception->next = reversed;
+		reversed = exception;
+	}
+
+	// Lock-free push of the whole chain: the taker takes the whole stack at once, so there
+	// is no ABA problem
+	Exception *bottom = self->head;
+	Exception *top = __atomic_load_n(stack, __ATOMIC_RELAXED);
+	do
+		bottom->next = top;
+	while (!__atomic_compare_exchange_n(stack, &top, reversed, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	ExceptionQueue_create(self);
+}
+
+void ExceptionQueue_take_stack(ExceptionQueue *self, Exception **stack) {
+	if (!__atomic_load_n(stack, __ATOMIC_RELAXED))
+		return;
+
+	Exception *reversed = NULL;
+	for (Exception *exception = __atomic_exchange_n(stack, NULL, __ATOMIC_ACQUIRE), *next; exception; exception = next) {
+		next = exception->next;
+		exception->next = reversed;
+		reversed = exception;
+	}
+
+	for (Exception *exception = reversed, *next; exception; exception = next) {
+		next = exception->next;
+		ExceptionQueue_append(self, exception);
+	}
+}
+
+Exception *ExceptionQueue_get(ExceptionQueue *self, int index) {
+	if ((index < 0) || (index >= self->count))
+		return NULL;
+	Exception *exception = self->head;
+	while (index--)
+		exception = exception->next;
+	return exception;
+}
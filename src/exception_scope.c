@@ -2,58 +2,89 @@
 #include <stddef.h>
 
 void ExceptionScope_create(ExceptionScope *self) {
-	#ifdef _OPENMP
-	omp_init_lock(&self->lock);
-	#endif
-	list_init(&self->captured_exceptions);
+	self->get = NULL;
+	self->destroy = NULL;
+	self->captured_exceptions = NULL;
+	self->aggregator = NULL;
+	self->cancelled = false;
+	self->done = false;
 }
 
 void ExceptionScope_destroy(ExceptionScope *self) {
-	#ifdef _OPENMP
-	omp_destroy_lock(&self->lock);
-	#endif
-	if (exceptional_list_destroy_with_elements(&self->captured_exceptions, (exceptional_list_destroy_element_fn) Exception_destroy))
-		self->captured_exceptions = (list_t) {0};
+	if (self->captured_exceptions) {
+		ExceptionQueue captured;
+		ExceptionQueue_create(&captured);
+		ExceptionQueue_take_stack(&captured, &self->captured_exceptions);
+		ExceptionQueue_destroy(&captured);
+	}
+	if (self->aggregator) {
+		ExceptionAggregator_destroy_and_free(self->aggregator);
+		self->aggregator = NULL;
+	}
+	if (self->destroy)
+		self->destroy(self);
 }
 
 void ExceptionScope_move_exceptions_to_other_context(ExceptionScope *self, ExceptionScope *relay) {
 	ExceptionContext *context = self->get(self);
 	ExceptionContext *relay_context = relay->get(relay);
-	exceptional_list_move(&context->exceptions, &relay_context->exceptions);
+	ExceptionQueue_splice(&relay_context->exceptions, &context->exceptions);
 }
 
-void ExceptionScope_move_exceptions_from_context(ExceptionScope *self) {
+void ExceptionScope_move_exceptions_from_context(ExceptionScope *self, long payload) {
+	// Other threads might be capturing into this scope at the same time
 	ExceptionContext *context = self->get(self);
-	if (!list_empty(&context->exceptions)) {
-		#ifdef _OPENMP
-		omp_set_lock(&self->lock);
-		#endif
-		exceptional_list_for_each (&context->exceptions, Exception, exception)
-			list_append(&self->captured_exceptions, exception);
-		#ifdef _OPENMP
-		omp_unset_lock(&self->lock);
-		#endif
-		list_clear(&context->exceptions);
+	if (self->aggregator) {
+		Exception *exception;
+		while ((exception = ExceptionQueue_remove(&context->exceptions, NULL)))
+			ExceptionAggregator_add(self->aggregator, exception, payload);
 	}
+	else
+		ExceptionQueue_push_stack(&context->exceptions, &self->captured_exceptions);
 }
 
 void ExceptionScope_move_exceptions_to_context(ExceptionScope *self) {
 	// Move all captured exceptions from scope to context
 	ExceptionContext *context = self->get(self);
-	exceptional_list_move(&self->captured_exceptions, &context->exceptions);
+	if (self->aggregator)
+		ExceptionAggregator_take(self->aggregator, &context->exceptions);
+	ExceptionQueue_take_stack(&context->exceptions, &self->captured_exceptions);
+
+	// The loop is over, so the scope can capture (and cancel) again
+	self->cancelled = false;
 }
 
 void ExceptionScope_dump_captured_exceptions(ExceptionScope *self, FILE *file) {
-	exceptional_list_for_each (&self->captured_exceptions, Exception, exception) {
+	// Newest first
+	for (Exception *exception = __atomic_load_n(&self->captured_exceptions, __ATOMIC_ACQUIRE); exception; exception = exception->next) {
 		fprintf(file, ANSI_COLOR_BRIGHT_RED "  ! ");
 		Exception_dump(exception, file, EXCEPTION_DUMP_LONG);
 		fprintf(file, ANSI_COLOR_RESET);
 	}
+	if (self->aggregator)
+		for (ExceptionAggregate *aggregate = __atomic_load_n(&self->aggregator->created, __ATOMIC_ACQUIRE); aggregate; aggregate = aggregate->next_created) {
+			fprintf(file, ANSI_COLOR_BRIGHT_RED "  ! ");
+			Exception_dump(aggregate->exception, file, EXCEPTION_DUMP_LONG);
+			fprintf(file, ANSI_COLOR_RESET);
+		}
+}
+
+void ExceptionScope_cancel(ExceptionScope *self) {
+	__atomic_store_n(&self->cancelled, true, __ATOMIC_RELAXED);
+}
+
+void ExceptionScope_aggregate(ExceptionScope *self, bool by_message) {
+	if (!self->aggregator)
+		self->aggregator = ExceptionAggregator_new(by_message);
+	else
+		self->aggregator->by_message = by_message;
 }
 
 // Helpers
 
-bool ExceptionScope_with_exceptions_relay(ExceptionScope *self, ExceptionScope *relay, jmp_buf *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn) {
+// "own_relay" is for "with_exceptions_relay_to", whose block creates the relay scope;
+// "with_exceptions_relay" relays to the enclosing scope, which is still in use by its own block
+static bool ExceptionScope_relay(ExceptionScope *self, ExceptionScope *relay, bool own_relay, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn) {
 	ExceptionContext *context = self->get(self);
 
 	if (reason) {
@@ -62,23 +93,24 @@ bool ExceptionScope_with_exceptions_relay(ExceptionScope *self, ExceptionScope *
 		ExceptionContext *relay_context = relay->get(relay);
 		ExceptionScope_move_exceptions_to_other_context(self, relay);
 
-		if (exceptional_debug) {
+		if (EXCEPTIONAL_DEBUGGING) {
 			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "end", NULL);
 			ExceptionContext_dump_exceptions(relay_context, exceptional_debug);
 			ExceptionContext_dump_frames(relay_context, exceptional_debug);
 		}
 
 		ExceptionScope_destroy(self);
-		ExceptionScope_destroy(relay);
+		if (own_relay)
+			ExceptionScope_destroy(relay);
 		ExceptionContext_jump_because(relay_context, reason); // important: jumping to the *relay* stack
 		return false; // not supposed to get here
 	}
 	else {
 		// All we did was set the jump point
 
-		ExceptionContext_push_frame(context, jmp, JUMP_REASON_DONT, false, false, "with_exceptions_relay", file, line, fn);
+		ExceptionContext_push_frame(context, frame, jmp, JUMP_REASON_DONT, false, false, "with_exceptions_relay", file, line, fn);
 
-		if (exceptional_debug) {
+		if (EXCEPTIONAL_DEBUGGING) {
 			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "begin", NULL);
 			ExceptionContext_dump_exceptions(context, exceptional_debug);
 			ExceptionContext_dump_frames(context, exceptional_debug);
@@ -88,14 +120,14 @@ bool ExceptionScope_with_exceptions_relay(ExceptionScope *self, ExceptionScope *
 	}
 }
 
-void ExceptionScope_with_exceptions_relay_done(ExceptionScope *self, ExceptionScope *relay) {
+static void ExceptionScope_relay_done(ExceptionScope *self, ExceptionScope *relay, bool own_relay) {
 	ExceptionContext *context = self->get(self);
 	ExceptionContext *relay_context = relay->get(relay);
 
 	// Uncapture locally
 	ExceptionScope_move_exceptions_to_context(self);
 
-	if (exceptional_debug) {
+	if (EXCEPTIONAL_DEBUGGING) {
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
 		ExceptionContext_dump_exceptions(context, exceptional_debug);
 		ExceptionContext_dump_frames(context, exceptional_debug);
@@ -106,35 +138,52 @@ void ExceptionScope_with_exceptions_relay_done(ExceptionScope *self, ExceptionSc
 
 	ExceptionContext_pop_frame(context);
 	ExceptionScope_destroy(self);
-	ExceptionScope_destroy(relay);
+	if (own_relay)
+		ExceptionScope_destroy(relay);
 
 	if (ExceptionContext_has_exceptions(relay_context))
 		// We have relay exceptions, so throw them
 		ExceptionContext_jump_because(relay_context, JUMP_REASON_THROW);
 }
 
-bool ExceptionScope_capture_exceptions(ExceptionScope *self, jmp_buf *jmp, JumpReason reason, const char *file, int line, const char *fn) {
+bool ExceptionScope_with_exceptions_relay(ExceptionScope *self, ExceptionScope *relay, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn) {
+	return ExceptionScope_relay(self, relay, false, frame, jmp, reason, keyword, file, line, fn);
+}
+
+void ExceptionScope_with_exceptions_relay_done(ExceptionScope *self, ExceptionScope *relay) {
+	ExceptionScope_relay_done(self, relay, false);
+}
+
+bool ExceptionScope_with_exceptions_relay_to(ExceptionScope *self, ExceptionScope *relay, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *keyword, const char *file, int line, const char *fn) {
+	return ExceptionScope_relay(self, relay, true, frame, jmp, reason, keyword, file, line, fn);
+}
+
+void ExceptionScope_with_exceptions_relay_to_done(ExceptionScope *self, ExceptionScope *relay) {
+	ExceptionScope_relay_done(self, relay, true);
+}
+
+bool ExceptionScope_capture_exceptions(ExceptionScope *self, long payload, ExceptionFrame *frame, ExceptionJumpBuffer *jmp, JumpReason reason, const char *file, int line, const char *fn) {
 	ExceptionContext *context = self->get(self);
 
 	if (reason) {
 		// We've jumped here due to an uncaught exception
 
-		if (exceptional_debug) {
+		if (EXCEPTIONAL_DEBUGGING) {
 			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "end", NULL);
 			ExceptionContext_dump_exceptions(context, exceptional_debug);
 			ExceptionContext_dump_frames(context, exceptional_debug);
 		}
 
-		ExceptionScope_move_exceptions_from_context(self);
+		ExceptionScope_move_exceptions_from_context(self, payload);
 
 		return false;
 	}
 	else {
 		// All we did was set the jump point
 
-		ExceptionContext_push_frame(context, jmp, JUMP_REASON_DONT, false, false, "capture_exceptions", file, line, fn);
+		ExceptionContext_push_frame(context, frame, jmp, JUMP_REASON_DONT, false, false, "capture_exceptions", file, line, fn);
 
-		if (exceptional_debug) {
+		if (EXCEPTIONAL_DEBUGGING) {
 			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "begin", NULL);
 			ExceptionContext_dump_exceptions(context, exceptional_debug);
 			ExceptionContext_dump_frames(context, exceptional_debug);
@@ -147,7 +196,7 @@ bool ExceptionScope_capture_exceptions(ExceptionScope *self, jmp_buf *jmp, JumpR
 void ExceptionScope_uncapture_exceptions(ExceptionScope *self) {
 	ExceptionScope_move_exceptions_to_context(self);
 
-	if (exceptional_debug) {
+	if (EXCEPTIONAL_DEBUGGING) {
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
 		ExceptionContext *context = self->get(self);
 		ExceptionContext_dump_exceptions(context, exceptional_debug);
@@ -163,7 +212,7 @@ void ExceptionScope_throw_captured(ExceptionScope *self) {
 	if (ExceptionContext_has_exceptions(context)) {
 		// We have exceptions, so throw
 
-		if (exceptional_debug) {
+		if (EXCEPTIONAL_DEBUGGING) {
 			exceptional_dump_fn(exceptional_debug, __FUNCTION__, "throwing", NULL);
 			ExceptionContext_dump_exceptions(context, exceptional_debug);
 			ExceptionContext_dump_frames(context, exceptional_debug);
@@ -175,7 +224,7 @@ void ExceptionScope_throw_captured(ExceptionScope *self) {
 		else
 			ExceptionContext_jump_because(context, JUMP_REASON_THROW);
 	}
-	else if (exceptional_debug) {
+	else if (EXCEPTIONAL_DEBUGGING) {
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, "not throwing", NULL);
 		ExceptionContext_dump_exceptions(context, exceptional_debug);
 		ExceptionContext_dump_frames(context, exceptional_debug);
@@ -1,9 +1,9 @@
 #include "exceptional.h"
 
-static ExceptionContext exception_context_global = {0};
+ExceptionContext exception_context_global = {0};
 
 void ExceptionScope_shutdown_global() {
-	if (exceptional_debug)
+	if (EXCEPTIONAL_DEBUGGING)
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
 	ExceptionContext_destroy(&exception_context_global);
 }
@@ -13,14 +13,11 @@ static ExceptionContext *ExceptionScope_global_get(ExceptionScope_global *scope)
 }
 
 void ExceptionScope_global_create(ExceptionScope_global *self) {
-	ExceptionScope_create(&self->super);
-	if (!exception_context_global.valid)
-		ExceptionContext_create(&exception_context_global);
-	self->super.get = (ExceptionScope_get_fn) ExceptionScope_global_get;
+	*self = ExceptionScope_global_new();
 }
 
 ExceptionScope_global ExceptionScope_global_new() {
-	ExceptionScope_global scope = {0};
-	ExceptionScope_global_create(&scope);
-	return scope;
+	return (ExceptionScope_global) {
+		.super.get = (ExceptionScope_get_fn) ExceptionScope_global_get
+	};
 }
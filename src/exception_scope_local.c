@@ -4,14 +4,17 @@ static ExceptionContext *ExceptionScope_local_get(ExceptionScope_local *scope) {
 	return &scope->local_context;
 }
 
+static void ExceptionScope_local_destroy(ExceptionScope_local *scope) {
+	ExceptionContext_destroy(&scope->local_context);
+}
+
 void ExceptionScope_local_create(ExceptionScope_local *self) {
-	ExceptionScope_create(&self->super);
-	self->super.get = (ExceptionScope_get_fn) ExceptionScope_local_get;
-	ExceptionContext_create(&self->local_context);
+	*self = ExceptionScope_local_new();
 }
 
 ExceptionScope_local ExceptionScope_local_new() {
-	ExceptionScope_local scope = {0};
-	ExceptionScope_local_create(&scope);
-	return scope;
+	return (ExceptionScope_local) {
+		.super.get = (ExceptionScope_get_fn) ExceptionScope_local_get,
+		.super.destroy = (ExceptionScope_destroy_fn) ExceptionScope_local_destroy
+	};
 }
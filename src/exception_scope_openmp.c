@@ -1,43 +1,67 @@
 #ifdef _OPENMP
 
 #include "exceptional.h"
+#include <pthread.h>
 #include <stdlib.h>
 
-static ExceptionContext exception_context_openmp;
+// Valid zero-initialized, so every thread of every team (including nested and dynamically
+// sized teams) starts out with empty contexts. A thread has one per nesting level, so that
+// frames and exceptions of a team it spawns are never mixed with those of its own team.
+static ExceptionContext exception_context_openmp[EXCEPTIONAL_OPENMP_LEVELS];
 #pragma omp threadprivate(exception_context_openmp)
 
+// Only used to free the contexts when the thread exits
+static bool exception_context_openmp_registered = false;
+#pragma omp threadprivate(exception_context_openmp_registered)
+static pthread_key_t exception_context_openmp_key;
+static pthread_once_t exception_context_openmp_key_once = PTHREAD_ONCE_INIT;
+
+static void ExceptionScope_openmp_destroy_contexts(ExceptionContext *contexts) {
+	for (int level = 0; level < EXCEPTIONAL_OPENMP_LEVELS; level++)
+		ExceptionContext_destroy(&contexts[level]);
+}
+
+static void ExceptionScope_openmp_create_key() {
+	pthread_key_create(&exception_context_openmp_key, (void (*)(void *)) ExceptionScope_openmp_destroy_contexts);
+}
+
+static void ExceptionScope_openmp_register() {
+	if (EXCEPTIONAL_DEBUGGING)
+		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
+	pthread_once(&exception_context_openmp_key_once, ExceptionScope_openmp_create_key);
+	pthread_setspecific(exception_context_openmp_key, exception_context_openmp);
+	exception_context_openmp_registered = true;
+}
+
 void ExceptionScope_initialize_openmp() {
-	#pragma omp parallel
-	{
-		if (exceptional_debug)
-			exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
-		exception_context_openmp = (ExceptionContext) {0};
-		ExceptionContext_create(&exception_context_openmp);
-	}
+	// Contexts are initialized lazily, so all that's left is to pre-warm the unwinder
+#ifdef EXCEPTIONAL_BACKTRACE
+	ExceptionBacktrace_initialize();
+#endif
 }
 
 void ExceptionScope_shutdown_openmp() {
-	#pragma omp parallel
-	{
-		if (exceptional_debug)
-			exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
-		ExceptionContext_destroy(&exception_context_openmp);
-	}
+	// Other threads free their contexts when they exit
+	if (EXCEPTIONAL_DEBUGGING)
+		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
+	ExceptionScope_openmp_destroy_contexts(exception_context_openmp);
 }
 
-static ExceptionContext *ExceptionScope_openmp_get(ExceptionScope_openmp *scope) {
-	return &exception_context_openmp;
+ExceptionContext *ExceptionScope_openmp_get(ExceptionScope_openmp *scope) {
+	if (EXCEPTIONAL_UNLIKELY(!exception_context_openmp_registered))
+		ExceptionScope_openmp_register();
+	int level = omp_get_level();
+	return &exception_context_openmp[level < EXCEPTIONAL_OPENMP_LEVELS ? level : EXCEPTIONAL_OPENMP_LEVELS - 1];
 }
 
 void ExceptionScope_openmp_create(ExceptionScope_openmp *self) {
-	ExceptionScope_create(&self->super);
-	self->super.get = (ExceptionScope_get_fn) ExceptionScope_openmp_get;
+	*self = ExceptionScope_openmp_new();
 }
 
 ExceptionScope_openmp ExceptionScope_openmp_new() {
-	ExceptionScope_openmp scope = {0};
-	ExceptionScope_openmp_create(&scope);
-	return scope;
+	return (ExceptionScope_openmp) {
+		.super.get = (ExceptionScope_get_fn) ExceptionScope_openmp_get
+	};
 }
 
 #endif
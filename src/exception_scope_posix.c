@@ -7,41 +7,43 @@ static pthread_key_t exception_context_posix = 0;
 typedef void (*pthread_key_destroy_fn)(void *);
 
 void ExceptionScope_initialize_posix() {
-	if (exceptional_debug)
+	if (EXCEPTIONAL_DEBUGGING)
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
 	pthread_key_create(&exception_context_posix, (pthread_key_destroy_fn) ExceptionContext_destroy_and_free);
+#ifdef EXCEPTIONAL_BACKTRACE
+	ExceptionBacktrace_initialize();
+#endif
 }
 
 void ExceptionScope_shutdown_posix() {
-	if (exceptional_debug)
+	if (EXCEPTIONAL_DEBUGGING)
 		exceptional_dump_fn(exceptional_debug, __FUNCTION__, NULL, NULL);
 	pthread_key_delete(exception_context_posix);
 }
 
-static ExceptionContext *ExceptionScope_posix_get(ExceptionScope_posix *scope) {
+ExceptionContext *ExceptionScope_posix_get(ExceptionScope_posix *scope) {
+	if (!scope->context) {
+		// Thread-local context (we only look it up when the scope is first used)
+		ExceptionContext *context = pthread_getspecific(exception_context_posix);
+		if (!context) {
+			context = malloc(sizeof(ExceptionContext));
+			ExceptionContext_create(context);
+			pthread_setspecific(exception_context_posix, context);
+		}
+		else
+			// The context may have been previously used
+			ExceptionContext_reset(context);
+		scope->context = context;
+	}
 	return scope->context;
 }
 
 void ExceptionScope_posix_create(ExceptionScope_posix *self) {
-	ExceptionScope_create(&self->super);
-
-	// Thread-local context
-	ExceptionContext *context = pthread_getspecific(exception_context_posix);
-	if (!context) {
-		context = malloc(sizeof(ExceptionContext));
-		ExceptionContext_create(context);
-		pthread_setspecific(exception_context_posix, context);
-	}
-	else
-		// The context may have been previously used
-		ExceptionContext_destroy(context);
-
-	self->super.get = (ExceptionScope_get_fn) ExceptionScope_posix_get;
-	self->context = context;
+	*self = ExceptionScope_posix_new();
 }
 
 ExceptionScope_posix ExceptionScope_posix_new() {
-	ExceptionScope_posix scope = {0};
-	ExceptionScope_posix_create(&scope);
-	return scope;
+	return (ExceptionScope_posix) {
+		.super.get = (ExceptionScope_get_fn) ExceptionScope_posix_get
+	};
 }
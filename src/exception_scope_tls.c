@@ -0,0 +1,50 @@
+#include "exceptional.h"
+#include <pthread.h>
+
+// Valid zero-initialized, so every thread starts out with an empty context
+__thread ExceptionContext exception_context_tls;
+
+#ifndef EXCEPTIONAL_STACK_FRAMES
+
+// Only used to free the frame storage when the thread exits
+static __thread bool exception_context_tls_registered = false;
+static pthread_key_t exception_context_tls_key;
+static pthread_once_t exception_context_tls_key_once = PTHREAD_ONCE_INIT;
+
+static void ExceptionScope_tls_create_key() {
+	pthread_key_create(&exception_context_tls_key, (void (*)(void *)) ExceptionContext_destroy);
+}
+
+#endif
+
+static ExceptionContext *ExceptionScope_tls_get(ExceptionScope_tls *scope) {
+	return &exception_context_tls;
+}
+
+static void ExceptionScope_tls_destroy(ExceptionScope_tls *scope) {
+	ExceptionContext *context = &exception_context_tls;
+
+	// Uncaught exceptions are not accessible after the outermost block (but if we are nested
+	// in another block using this context, they are still in play)
+	if (context->exceptions.head && !ExceptionContext_get_current_frame(context))
+		ExceptionQueue_destroy(&context->exceptions);
+
+#ifndef EXCEPTIONAL_STACK_FRAMES
+	if (!exception_context_tls_registered && context->frames) {
+		pthread_once(&exception_context_tls_key_once, ExceptionScope_tls_create_key);
+		pthread_setspecific(exception_context_tls_key, context);
+		exception_context_tls_registered = true;
+	}
+#endif
+}
+
+void ExceptionScope_tls_create(ExceptionScope_tls *self) {
+	*self = ExceptionScope_tls_new();
+}
+
+ExceptionScope_tls ExceptionScope_tls_new() {
+	return (ExceptionScope_tls) {
+		.super.get = (ExceptionScope_get_fn) ExceptionScope_tls_get,
+		.super.destroy = (ExceptionScope_destroy_fn) ExceptionScope_tls_destroy
+	};
+}
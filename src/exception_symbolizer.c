@@ -0,0 +1,772 @@
+#ifdef EXCEPTIONAL_BACKTRACE
+
+#define _GNU_SOURCE // for dl_iterate_phdr
+
+#include "exceptional.h"
+#include <elf.h>
+#include <fcntl.h>
+#include <link.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef SHF_COMPRESSED
+#define SHF_COMPRESSED (1 << 11)
+#endif
+
+#define MAX_EXE_NAME_SIZE 1024
+
+/*
+ * A slot of the symbol cache, protected by a sequence lock: "sequence" is odd while
+ * a writer is filling the slot, and readers retry (or rather, give up) if it changed
+ * while they were copying. Everything a symbol points to lives for the life of the
+ * process, so copies stay valid after the slot is reused.
+ */
+typedef struct ExceptionSymbolizerSlot {
+	unsigned long sequence;
+	void *address;
+	ExceptionSymbol symbol;
+} ExceptionSymbolizerSlot;
+
+static ExceptionSymbolizerSlot cache[EXCEPTIONAL_SYMBOL_CACHE_SIZE];
+
+typedef struct ExceptionSymbolizerFunction {
+	uintptr_t address;
+	size_t size;
+	const char *name;
+} ExceptionSymbolizerFunction;
+
+typedef struct ExceptionSymbolizerLine {
+	uintptr_t address;
+	const char *file;
+	int line;
+	bool end_sequence;
+} ExceptionSymbolizerLine;
+
+/*
+ * An executable or shared object as loaded by the dynamic linker. Its symbol and line
+ * tables are read the first time we need them, and are kept for the life of the process:
+ * symbols handed out (and cached) point into them. So we never notice a dlclose, and
+ * addresses later mapped to another object in the same range resolve to the old one.
+ */
+typedef struct ExceptionSymbolizerModule {
+	char *path;
+	bool main;
+	uintptr_t bias;       // difference between runtime and link-time addresses
+	uintptr_t start, end; // runtime addresses of all PT_LOAD segments
+	bool loaded;
+	ExceptionSymbolizerFunction *functions;
+	size_t function_count;
+	ExceptionSymbolizerLine *lines;
+	size_t line_count;
+	struct ExceptionSymbolizerModule *next;
+} ExceptionSymbolizerModule;
+
+static ExceptionSymbolizerModule *modules = NULL;
+static pthread_mutex_t modules_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//
+// Reading
+//
+
+typedef struct ExceptionSymbolizerReader {
+	const unsigned char *p, *end;
+	bool dwarf64;
+} ExceptionSymbolizerReader;
+
+static bool ExceptionSymbolizerReader_has(ExceptionSymbolizerReader *self, size_t size) {
+	if ((size_t) (self->end - self->p) >= size)
+		return true;
+	// Make all further reads fail
+	self->p = self->end;
+	return false;
+}
+
+#define READ_FIXED(NAME, TYPE) \
+	static TYPE ExceptionSymbolizerReader_##NAME(ExceptionSymbolizerReader *self) { \
+		TYPE value = 0; \
+		if (ExceptionSymbolizerReader_has(self, sizeof(TYPE))) { \
+			memcpy(&value, self->p, sizeof(TYPE)); \
+			self->p += sizeof(TYPE); \
+		} \
+		return value; \
+	}
+
+READ_FIXED(u8, uint8_t)
+READ_FIXED(u16, uint16_t)
+READ_FIXED(u32, uint32_t)
+READ_FIXED(u64, uint64_t)
+
+static uint64_t ExceptionSymbolizerReader_uleb(ExceptionSymbolizerReader *self) {
+	uint64_t value = 0;
+	for (int shift = 0; self->p < self->end; shift += 7) {
+		unsigned char byte = *self->p++;
+		if (shift < 64)
+			value |= (uint64_t) (byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			break;
+	}
+	return value;
+}
+
+static int64_t ExceptionSymbolizerReader_sleb(ExceptionSymbolizerReader *self) {
+	int64_t value = 0;
+	int shift = 0;
+	unsigned char byte = 0;
+	while (self->p < self->end) {
+		byte = *self->p++;
+		if (shift < 64)
+			value |= (int64_t) (byte & 0x7f) << shift;
+		shift += 7;
+		if (!(byte & 0x80))
+			break;
+	}
+	if ((shift < 64) && (byte & 0x40))
+		value |= -((int64_t) 1 << shift);
+	return value;
+}
+
+static const char *ExceptionSymbolizerReader_string(ExceptionSymbolizerReader *self) {
+	const unsigned char *terminator = memchr(self->p, 0, self->end - self->p);
+	if (!terminator) {
+		self->p = self->end;
+		return NULL;
+	}
+	const char *string = (const char *) self->p;
+	self->p = terminator + 1;
+	return string;
+}
+
+static uint64_t ExceptionSymbolizerReader_offset(ExceptionSymbolizerReader *self) {
+	return self->dwarf64 ? ExceptionSymbolizerReader_u64(self) : ExceptionSymbolizerReader_u32(self);
+}
+
+static void ExceptionSymbolizerReader_skip(ExceptionSymbolizerReader *self, uint64_t size) {
+	if (ExceptionSymbolizerReader_has(self, size))
+		self->p += size;
+}
+
+//
+// ELF
+//
+
+typedef struct ExceptionSymbolizerSection {
+	const unsigned char *data;
+	size_t size;
+} ExceptionSymbolizerSection;
+
+typedef struct ExceptionSymbolizerImage {
+	const unsigned char *data;
+	size_t size;
+	const ElfW(Shdr) *sections;
+	int section_count;
+	const char *section_names;
+	size_t section_names_size;
+} ExceptionSymbolizerImage;
+
+static bool ExceptionSymbolizerImage_section(ExceptionSymbolizerImage *self, int index, ExceptionSymbolizerSection *section) {
+	if ((index <= 0) || (index >= self->section_count))
+		return false;
+	const ElfW(Shdr) *header = &self->sections[index];
+	// We can't read compressed debug sections, and NOBITS sections have no data in the file
+	if ((header->sh_type == SHT_NOBITS) || (header->sh_flags & SHF_COMPRESSED))
+		return false;
+	if ((header->sh_offset > self->size) || (header->sh_size > self->size - header->sh_offset))
+		return false;
+	section->data = self->data + header->sh_offset;
+	section->size = header->sh_size;
+	return true;
+}
+
+static int ExceptionSymbolizerImage_find(ExceptionSymbolizerImage *self, const char *name) {
+	for (int i = 1; i < self->section_count; i++) {
+		size_t offset = self->sections[i].sh_name;
+		if ((offset < self->section_names_size) && !strcmp(self->section_names + offset, name))
+			return i;
+	}
+	return 0;
+}
+
+static bool ExceptionSymbolizerImage_open(ExceptionSymbolizerImage *self, const char *path) {
+	int fd = open(path, O_RDONLY);
+	if (fd == -1)
+		return false;
+	struct stat st;
+	if ((fstat(fd, &st) == -1) || (st.st_size < (off_t) sizeof(ElfW(Ehdr)))) {
+		close(fd);
+		return false;
+	}
+	// The mapping is never released, so that names can point straight into it
+	void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+
+	self->data = data;
+	self->size = st.st_size;
+	const ElfW(Ehdr) *header = data;
+	if (memcmp(header->e_ident, ELFMAG, SELFMAG) || (header->e_ident[EI_CLASS] != (sizeof(void *) == 8 ? ELFCLASS64 : ELFCLASS32))
+		|| (header->e_shentsize != sizeof(ElfW(Shdr))) || (header->e_shoff > self->size)
+		|| (header->e_shnum > (self->size - header->e_shoff) / sizeof(ElfW(Shdr)))) {
+		munmap(data, st.st_size);
+		return false;
+	}
+	self->sections = (const ElfW(Shdr) *) (self->data + header->e_shoff);
+	self->section_count = header->e_shnum;
+
+	ExceptionSymbolizerSection names;
+	self->section_names = NULL;
+	self->section_names_size = 0;
+	if (ExceptionSymbolizerImage_section(self, header->e_shstrndx, &names)) {
+		self->section_names = (const char *) names.data;
+		self->section_names_size = names.size;
+	}
+	return true;
+}
+
+//
+// Functions
+//
+
+static int ExceptionSymbolizerFunction_compare(const void *a, const void *b) {
+	uintptr_t x = ((const ExceptionSymbolizerFunction *) a)->address, y = ((const ExceptionSymbolizerFunction *) b)->address;
+	return x < y ? -1 : x > y;
+}
+
+static void ExceptionSymbolizerModule_load_functions(ExceptionSymbolizerModule *self, ExceptionSymbolizerImage *image) {
+	// The full symbol table if it's there (not stripped), otherwise the dynamic one
+	int index = ExceptionSymbolizerImage_find(image, ".symtab");
+	if (!index)
+		index = ExceptionSymbolizerImage_find(image, ".dynsym");
+	ExceptionSymbolizerSection symbols, strings;
+	if (!ExceptionSymbolizerImage_section(image, index, &symbols)
+		|| !ExceptionSymbolizerImage_section(image, image->sections[index].sh_link, &strings))
+		return;
+
+	const ElfW(Sym) *symbol = (const ElfW(Sym) *) symbols.data;
+	size_t count = symbols.size / sizeof(ElfW(Sym));
+	self->functions = malloc(count * sizeof(ExceptionSymbolizerFunction));
+	for (size_t i = 0; i < count; i++, symbol++) {
+		int type = ELF64_ST_TYPE(symbol->st_info);
+		if (((type != STT_FUNC) && (type != STT_GNU_IFUNC)) || (symbol->st_shndx == SHN_UNDEF)
+			|| !symbol->st_value || (symbol->st_name >= strings.size))
+			continue;
+		ExceptionSymbolizerFunction *function = &self->functions[self->function_count++];
+		function->address = symbol->st_value;
+		function->size = symbol->st_size;
+		function->name = (const char *) strings.data + symbol->st_name;
+	}
+	qsort(self->functions, self->function_count, sizeof(ExceptionSymbolizerFunction), ExceptionSymbolizerFunction_compare);
+}
+
+static ExceptionSymbolizerFunction *ExceptionSymbolizerModule_find_function(ExceptionSymbolizerModule *self, uintptr_t address) {
+	// Last function starting at or before the address
+	size_t low = 0, high = self->function_count;
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (self->functions[middle].address <= address)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if (low == 0)
+		return NULL;
+	ExceptionSymbolizerFunction *function = &self->functions[low - 1];
+	if (function->size && (address >= function->address + function->size))
+		return NULL;
+	return function;
+}
+
+//
+// Lines
+//
+
+#define DW_LNS_copy               1
+#define DW_LNS_advance_pc         2
+#define DW_LNS_advance_line       3
+#define DW_LNS_set_file           4
+#define DW_LNS_const_add_pc       8
+#define DW_LNS_fixed_advance_pc   9
+#define DW_LNE_end_sequence       1
+#define DW_LNE_set_address        2
+#define DW_LNCT_path              1
+#define DW_LNCT_directory_index   2
+#define DW_FORM_block             0x09
+#define DW_FORM_block1            0x0a
+#define DW_FORM_block2            0x03
+#define DW_FORM_block4            0x04
+#define DW_FORM_data1             0x0b
+#define DW_FORM_data2             0x05
+#define DW_FORM_data4             0x06
+#define DW_FORM_data8             0x07
+#define DW_FORM_data16            0x1e
+#define DW_FORM_string            0x08
+#define DW_FORM_strp              0x0e
+#define DW_FORM_udata             0x0f
+#define DW_FORM_line_strp         0x1f
+
+#define MAX_ENTRY_FORMATS 16
+
+typedef struct ExceptionSymbolizerStrings {
+	ExceptionSymbolizerSection debug_str, debug_line_str;
+} ExceptionSymbolizerStrings;
+
+static int ExceptionSymbolizerLine_compare(const void *a, const void *b) {
+	const ExceptionSymbolizerLine *x = a, *y = b;
+	if (x->address != y->address)
+		return x->address < y->address ? -1 : 1;
+	// Where one sequence ends and another starts, the start wins
+	return (int) y->end_sequence - (int) x->end_sequence;
+}
+
+static void ExceptionSymbolizerModule_add_line(ExceptionSymbolizerModule *self, size_t *capacity, uintptr_t address, const char *file, int line, bool end_sequence) {
+	if (self->line_count == *capacity) {
+		*capacity = *capacity ? *capacity * 2 : 1024;
+		self->lines = realloc(self->lines, *capacity * sizeof(ExceptionSymbolizerLine));
+	}
+	ExceptionSymbolizerLine *row = &self->lines[self->line_count++];
+	row->address = address;
+	row->file = file;
+	row->line = line;
+	row->end_sequence = end_sequence;
+}
+
+/*
+ * Reads one attribute of a DWARF 5 directory or file name entry. Returns the string for
+ * string forms, and sets "number" for constant forms.
+ */
+static const char *ExceptionSymbolizer_read_form(ExceptionSymbolizerReader *reader, uint64_t form, ExceptionSymbolizerStrings *strings, uint64_t *number) {
+	const ExceptionSymbolizerSection *section = NULL;
+	uint64_t offset;
+	*number = 0;
+	switch (form) {
+	case DW_FORM_string: return ExceptionSymbolizerReader_string(reader);
+	case DW_FORM_strp: section = &strings->debug_str; break;
+	case DW_FORM_line_strp: section = &strings->debug_line_str; break;
+	case DW_FORM_udata: *number = ExceptionSymbolizerReader_uleb(reader); return NULL;
+	case DW_FORM_data1: *number = ExceptionSymbolizerReader_u8(reader); return NULL;
+	case DW_FORM_data2: *number = ExceptionSymbolizerReader_u16(reader); return NULL;
+	case DW_FORM_data4: *number = ExceptionSymbolizerReader_u32(reader); return NULL;
+	case DW_FORM_data8: *number = ExceptionSymbolizerReader_u64(reader); return NULL;
+	case DW_FORM_data16: ExceptionSymbolizerReader_skip(reader, 16); return NULL;
+	case DW_FORM_block: ExceptionSymbolizerReader_skip(reader, ExceptionSymbolizerReader_uleb(reader)); return NULL;
+	case DW_FORM_block1: ExceptionSymbolizerReader_skip(reader, ExceptionSymbolizerReader_u8(reader)); return NULL;
+	case DW_FORM_block2: ExceptionSymbolizerReader_skip(reader, ExceptionSymbolizerReader_u16(reader)); return NULL;
+	case DW_FORM_block4: ExceptionSymbolizerReader_skip(reader, ExceptionSymbolizerReader_u32(reader)); return NULL;
+	default:
+		// We can't know its size, so we can't go on
+		reader->p = reader->end;
+		return NULL;
+	}
+	offset = ExceptionSymbolizerReader_offset(reader);
+	if (!section->data || (offset >= section->size) || !memchr(section->data + offset, 0, section->size - offset))
+		return NULL;
+	return (const char *) section->data + offset;
+}
+
+static const char *ExceptionSymbolizer_join_path(const char *directory, const char *name) {
+	if (!name)
+		return NULL;
+	if ((name[0] == '/') || !directory || !directory[0])
+		return name;
+	// Kept for the life of the process, like the rest of the line table
+	size_t directory_length = strlen(directory), name_length = strlen(name);
+	char *path = malloc(directory_length + name_length + 2);
+	memcpy(path, directory, directory_length);
+	path[directory_length] = '/';
+	memcpy(path + directory_length + 1, name, name_length + 1);
+	return path;
+}
+
+/*
+ * Frees the joined file names that no line row ended up pointing to.
+ */
+static void ExceptionSymbolizer_free_names(const char **names, bool *joined, bool *used, uint64_t count) {
+	if (joined)
+		for (uint64_t i = 0; i < count; i++)
+			if (joined[i] && !(used && used[i]))
+				free((char *) names[i]);
+	free(names);
+	free(joined);
+	free(used);
+}
+
+/*
+ * Reads the directory and file name tables of a DWARF 5 line program header. When
+ * directories are given, "joined" marks the names that were allocated to join them.
+ */
+static bool ExceptionSymbolizer_read_entries(ExceptionSymbolizerReader *reader, ExceptionSymbolizerStrings *strings, const char **directories, uint64_t directory_count,
+	const char ***names, bool **joined, uint64_t *count) {
+	uint8_t format_count = ExceptionSymbolizerReader_u8(reader);
+	if (format_count > MAX_ENTRY_FORMATS)
+		return false;
+	uint64_t formats[MAX_ENTRY_FORMATS][2];
+	for (int i = 0; i < format_count; i++) {
+		formats[i][0] = ExceptionSymbolizerReader_uleb(reader);
+		formats[i][1] = ExceptionSymbolizerReader_uleb(reader);
+	}
+
+	*count = ExceptionSymbolizerReader_uleb(reader);
+	if (*count > (uint64_t) (reader->end - reader->p))
+		return false;
+	*names = calloc(*count ? *count : 1, sizeof(char *));
+	if (directories)
+		*joined = calloc(*count ? *count : 1, sizeof(bool));
+	for (uint64_t i = 0; (i < *count) && (reader->p < reader->end); i++) {
+		const char *path = NULL;
+		uint64_t directory = 0, number;
+		for (int f = 0; f < format_count; f++) {
+			const char *string = ExceptionSymbolizer_read_form(reader, formats[f][1], strings, &number);
+			if (formats[f][0] == DW_LNCT_path)
+				path = string;
+			else if (formats[f][0] == DW_LNCT_directory_index)
+				directory = number;
+		}
+		if (directories) {
+			(*names)[i] = ExceptionSymbolizer_join_path(directory < directory_count ? directories[directory] : NULL, path);
+			(*joined)[i] = (*names)[i] != path;
+		}
+		else
+			(*names)[i] = path;
+	}
+	return reader->p < reader->end;
+}
+
+static void ExceptionSymbolizerModule_load_unit(ExceptionSymbolizerModule *self, size_t *capacity, ExceptionSymbolizerReader *unit, ExceptionSymbolizerStrings *strings) {
+	uint16_t version = ExceptionSymbolizerReader_u16(unit);
+	if ((version < 2) || (version > 5))
+		return;
+	if (version >= 5) {
+		ExceptionSymbolizerReader_u8(unit); // address_size
+		ExceptionSymbolizerReader_u8(unit); // segment_selector_size
+	}
+	uint64_t header_length = ExceptionSymbolizerReader_offset(unit);
+	if (header_length > (uint64_t) (unit->end - unit->p))
+		return;
+	ExceptionSymbolizerReader program = { unit->p + header_length, unit->end, unit->dwarf64 };
+
+	uint8_t minimum_instruction_length = ExceptionSymbolizerReader_u8(unit);
+	if (version >= 4)
+		ExceptionSymbolizerReader_u8(unit); // maximum_operations_per_instruction (we don't support VLIW)
+	ExceptionSymbolizerReader_u8(unit); // default_is_stmt
+	int8_t line_base = (int8_t) ExceptionSymbolizerReader_u8(unit);
+	uint8_t line_range = ExceptionSymbolizerReader_u8(unit);
+	uint8_t opcode_base = ExceptionSymbolizerReader_u8(unit);
+	if (!line_range || !opcode_base)
+		return;
+	const unsigned char *standard_opcode_lengths = unit->p;
+	ExceptionSymbolizerReader_skip(unit, opcode_base - 1);
+	if (unit->p > program.p)
+		// The opcode lengths don't fit in the header
+		return;
+
+	const char **directories = NULL, **files = NULL;
+	bool *joined = NULL;
+	uint64_t directory_count = 0, file_count = 0;
+	if (version >= 5) {
+		// Entry 0 is the compilation directory and primary source file
+		if (!ExceptionSymbolizer_read_entries(unit, strings, NULL, 0, &directories, NULL, &directory_count)
+			|| !ExceptionSymbolizer_read_entries(unit, strings, directories, directory_count, &files, &joined, &file_count)) {
+			free(directories);
+			ExceptionSymbolizer_free_names(files, joined, NULL, file_count);
+			return;
+		}
+	}
+	else {
+		// Index 0 is the compilation directory, which isn't in the line table
+		const unsigned char *start = unit->p;
+		while (unit->p < unit->end && *unit->p) {
+			ExceptionSymbolizerReader_string(unit);
+			directory_count++;
+		}
+		unit->p = start;
+		directories = calloc(directory_count + 1, sizeof(char *));
+		for (uint64_t i = 1; i <= directory_count; i++)
+			directories[i] = ExceptionSymbolizerReader_string(unit);
+		directory_count++;
+		ExceptionSymbolizerReader_u8(unit);
+
+		start = unit->p;
+		while (unit->p < unit->end && *unit->p) {
+			ExceptionSymbolizerReader_string(unit);
+			ExceptionSymbolizerReader_uleb(unit);
+			ExceptionSymbolizerReader_uleb(unit);
+			ExceptionSymbolizerReader_uleb(unit);
+			file_count++;
+		}
+		unit->p = start;
+		files = calloc(file_count + 1, sizeof(char *));
+		joined = calloc(file_count + 1, sizeof(bool));
+		for (uint64_t i = 1; i <= file_count; i++) {
+			const char *name = ExceptionSymbolizerReader_string(unit);
+			uint64_t directory = ExceptionSymbolizerReader_uleb(unit);
+			ExceptionSymbolizerReader_uleb(unit); // modification time
+			ExceptionSymbolizerReader_uleb(unit); // length
+			files[i] = ExceptionSymbolizer_join_path(directory < directory_count ? directories[directory] : NULL, name);
+			joined[i] = files[i] != name;
+		}
+		file_count++;
+	}
+	free(directories);
+
+	// Run the line number program, noting which files the rows keep
+	bool *used = calloc(file_count ? file_count : 1, sizeof(bool));
+	uintptr_t address = 0;
+	uint64_t file = 1; // in every version, even though DWARF 5 numbers files from 0
+	int64_t line = 1;
+	while (program.p < program.end) {
+		uint8_t opcode = ExceptionSymbolizerReader_u8(&program);
+		if (opcode >= opcode_base) {
+			int adjusted = opcode - opcode_base;
+			address += (adjusted / line_range) * minimum_instruction_length;
+			line += line_base + (adjusted % line_range);
+			if (file < file_count)
+				used[file] = true;
+			ExceptionSymbolizerModule_add_line(self, capacity, address, file < file_count ? files[file] : NULL, line, false);
+		}
+		else if (opcode == 0) {
+			uint64_t length = ExceptionSymbolizerReader_uleb(&program);
+			if (!length || !ExceptionSymbolizerReader_has(&program, length))
+				break;
+			const unsigned char *next = program.p + length;
+			uint8_t extended = ExceptionSymbolizerReader_u8(&program);
+			if (extended == DW_LNE_end_sequence) {
+				ExceptionSymbolizerModule_add_line(self, capacity, address, NULL, 0, true);
+				address = 0;
+				file = 1;
+				line = 1;
+			}
+			else if (extended == DW_LNE_set_address) {
+				if (length - 1 == 8)
+					address = ExceptionSymbolizerReader_u64(&program);
+				else if (length - 1 == 4)
+					address = ExceptionSymbolizerReader_u32(&program);
+			}
+			program.p = next;
+		}
+		else switch (opcode) {
+		case DW_LNS_copy:
+			if (file < file_count)
+				used[file] = true;
+			ExceptionSymbolizerModule_add_line(self, capacity, address, file < file_count ? files[file] : NULL, line, false);
+			break;
+		case DW_LNS_advance_pc:
+			address += ExceptionSymbolizerReader_uleb(&program) * minimum_instruction_length;
+			break;
+		case DW_LNS_advance_line:
+			line += ExceptionSymbolizerReader_sleb(&program);
+			break;
+		case DW_LNS_set_file:
+			file = ExceptionSymbolizerReader_uleb(&program);
+			break;
+		case DW_LNS_const_add_pc:
+			address += ((255 - opcode_base) / line_range) * minimum_instruction_length;
+			break;
+		case DW_LNS_fixed_advance_pc:
+			address += ExceptionSymbolizerReader_u16(&program);
+			break;
+		default:
+			// Including the ones we don't care about (set_column, negate_stmt, etc.)
+			for (int i = 0; i < standard_opcode_lengths[opcode - 1]; i++)
+				ExceptionSymbolizerReader_uleb(&program);
+		}
+	}
+	ExceptionSymbolizer_free_names(files, joined, used, file_count);
+}
+
+static void ExceptionSymbolizerModule_load_lines(ExceptionSymbolizerModule *self, ExceptionSymbolizerImage *image) {
+	ExceptionSymbolizerSection debug_line;
+	if (!ExceptionSymbolizerImage_section(image, ExceptionSymbolizerImage_find(image, ".debug_line"), &debug_line))
+		return;
+	ExceptionSymbolizerStrings strings = {{0}, {0}};
+	ExceptionSymbolizerImage_section(image, ExceptionSymbolizerImage_find(image, ".debug_str"), &strings.debug_str);
+	ExceptionSymbolizerImage_section(image, ExceptionSymbolizerImage_find(image, ".debug_line_str"), &strings.debug_line_str);
+
+	size_t capacity = 0;
+	ExceptionSymbolizerReader reader = { debug_line.data, debug_line.data + debug_line.size, false };
+	while (reader.p < reader.end) {
+		uint64_t length = ExceptionSymbolizerReader_u32(&reader);
+		reader.dwarf64 = length == 0xffffffff;
+		if (reader.dwarf64)
+			length = ExceptionSymbolizerReader_u64(&reader);
+		if (!length || !ExceptionSymbolizerReader_has(&reader, length))
+			break;
+		ExceptionSymbolizerReader unit = { reader.p, reader.p + length, reader.dwarf64 };
+		ExceptionSymbolizerModule_load_unit(self, &capacity, &unit, &strings);
+		reader.p += length;
+	}
+
+	qsort(self->lines, self->line_count, sizeof(ExceptionSymbolizerLine), ExceptionSymbolizerLine_compare);
+}
+
+static ExceptionSymbolizerLine *ExceptionSymbolizerModule_find_line(ExceptionSymbolizerModule *self, uintptr_t address) {
+	// Last row at or before the address
+	size_t low = 0, high = self->line_count;
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (self->lines[middle].address <= address)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	if (low == 0)
+		return NULL;
+	ExceptionSymbolizerLine *line = &self->lines[low - 1];
+	// Past the end of a sequence means we have no line information for the address
+	return line->end_sequence || !line->file ? NULL : line;
+}
+
+//
+// Modules
+//
+
+static void ExceptionSymbolizerModule_load(ExceptionSymbolizerModule *self) {
+	self->loaded = true;
+	ExceptionSymbolizerImage image;
+	if (!ExceptionSymbolizerImage_open(&image, self->main ? "/proc/self/exe" : self->path))
+		return;
+	ExceptionSymbolizerModule_load_functions(self, &image);
+	ExceptionSymbolizerModule_load_lines(self, &image);
+}
+
+static int ExceptionSymbolizer_add_module(struct dl_phdr_info *info, size_t size, void *data) {
+	uintptr_t start = UINTPTR_MAX, end = 0;
+	for (int i = 0; i < info->dlpi_phnum; i++)
+		if (info->dlpi_phdr[i].p_type == PT_LOAD) {
+			uintptr_t segment = info->dlpi_addr + info->dlpi_phdr[i].p_vaddr;
+			if (segment < start)
+				start = segment;
+			if (segment + info->dlpi_phdr[i].p_memsz > end)
+				end = segment + info->dlpi_phdr[i].p_memsz;
+		}
+	if (!end)
+		return 0;
+
+	for (ExceptionSymbolizerModule *module = modules; module; module = module->next)
+		if ((module->start == start) && (module->end == end))
+			return 0;
+
+	ExceptionSymbolizerModule *module = calloc(1, sizeof(ExceptionSymbolizerModule));
+	module->bias = info->dlpi_addr;
+	module->start = start;
+	module->end = end;
+	if (info->dlpi_name && info->dlpi_name[0])
+		module->path = exceptional_strdup(info->dlpi_name);
+	else {
+		// The main program has no name here
+		module->main = true;
+		char exe_name[MAX_EXE_NAME_SIZE];
+		ssize_t r = readlink("/proc/self/exe", exe_name, sizeof(exe_name) - 1);
+		exe_name[r > 0 ? r : 0] = 0; // readlink doesn't add terminating null
+		module->path = exceptional_strdup(exe_name);
+	}
+	module->next = modules;
+	modules = module;
+	return 0;
+}
+
+static ExceptionSymbolizerModule *ExceptionSymbolizer_find_module(uintptr_t address) {
+	for (ExceptionSymbolizerModule *module = modules; module; module = module->next)
+		if ((address >= module->start) && (address < module->end))
+			return module;
+	return NULL;
+}
+
+static bool ExceptionSymbolizer_resolve(void *address, ExceptionSymbol *symbol) {
+	*symbol = (ExceptionSymbol) {0};
+	// Return addresses point after the call, which could already be the next line or function
+	uintptr_t pc = (uintptr_t) address - 1;
+
+	pthread_mutex_lock(&modules_mutex);
+	ExceptionSymbolizerModule *module = ExceptionSymbolizer_find_module(pc);
+	if (!module) {
+		// Maybe it was loaded (dlopen) since we last looked
+		dl_iterate_phdr(ExceptionSymbolizer_add_module, NULL);
+		module = ExceptionSymbolizer_find_module(pc);
+	}
+	if (module && !module->loaded)
+		ExceptionSymbolizerModule_load(module);
+	pthread_mutex_unlock(&modules_mutex);
+
+	if (!module)
+		return false;
+
+	// Symbols and line tables use link-time addresses
+	uintptr_t link_pc = pc - module->bias;
+	symbol->object = module->path;
+	symbol->offset = (uintptr_t) address - module->bias;
+	ExceptionSymbolizerFunction *function = ExceptionSymbolizerModule_find_function(module, link_pc);
+	if (function) {
+		symbol->function = function->name;
+		symbol->offset = link_pc + 1 - function->address;
+	}
+	ExceptionSymbolizerLine *line = ExceptionSymbolizerModule_find_line(module, link_pc);
+	if (line) {
+		symbol->file = line->file;
+		symbol->line = line->line;
+	}
+	return true;
+}
+
+//
+// Cache
+//
+
+static ExceptionSymbolizerSlot *ExceptionSymbolizer_slot(void *address) {
+	// Fibonacci hashing
+	uint64_t hash = (uint64_t) (uintptr_t) address * 0x9e3779b97f4a7c15ULL;
+	return &cache[(hash >> 32) % EXCEPTIONAL_SYMBOL_CACHE_SIZE];
+}
+
+static bool ExceptionSymbolizer_cache_get(void *address, ExceptionSymbol *symbol) {
+	ExceptionSymbolizerSlot *slot = ExceptionSymbolizer_slot(address);
+	unsigned long sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+	if ((sequence & 1) || (__atomic_load_n(&slot->address, __ATOMIC_RELAXED) != address))
+		return false;
+	symbol->object = __atomic_load_n(&slot->symbol.object, __ATOMIC_RELAXED);
+	symbol->function = __atomic_load_n(&slot->symbol.function, __ATOMIC_RELAXED);
+	symbol->offset = __atomic_load_n(&slot->symbol.offset, __ATOMIC_RELAXED);
+	symbol->file = __atomic_load_n(&slot->symbol.file, __ATOMIC_RELAXED);
+	symbol->line = __atomic_load_n(&slot->symbol.line, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == sequence;
+}
+
+static void ExceptionSymbolizer_cache_put(void *address, ExceptionSymbol *symbol) {
+	ExceptionSymbolizerSlot *slot = ExceptionSymbolizer_slot(address);
+	unsigned long sequence = __atomic_load_n(&slot->sequence, __ATOMIC_RELAXED);
+	// If another writer has the slot, we just don't cache: it's only a cache
+	if ((sequence & 1) || !__atomic_compare_exchange_n(&slot->sequence, &sequence, sequence + 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+		return;
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	// Whatever was in the slot is evicted
+	__atomic_store_n(&slot->address, address, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->symbol.object, symbol->object, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->symbol.function, symbol->function, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->symbol.offset, symbol->offset, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->symbol.file, symbol->file, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->symbol.line, symbol->line, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+bool ExceptionSymbolizer_symbolize(void *address, ExceptionSymbol *symbol) {
+	if (ExceptionSymbolizer_cache_get(address, symbol))
+		return true;
+	if (!ExceptionSymbolizer_resolve(address, symbol))
+		// Not cached: the address might belong to an object that is loaded later
+		return false;
+	ExceptionSymbolizer_cache_put(address, symbol);
+	return true;
+}
+
+void ExceptionSymbolizer_preload(const ExceptionBacktrace *backtrace) {
+	ExceptionSymbol symbol;
+	for (int i = 0; i < backtrace->size; i++)
+		ExceptionSymbolizer_symbolize(backtrace->frames[i], &symbol);
+}
+
+#endif
@@ -33,7 +33,43 @@ DEFINE_EXCEPTION_TYPE(InteractiveAttentionRequest, Signal, "A SIGINT has been ra
 DEFINE_EXCEPTION_TYPE(InvalidMemoryAccess, Signal, "A SIGSEGV has been raised");
 DEFINE_EXCEPTION_TYPE(TerminationRequest, Signal, "A SIGTERM has been raised");
 
+/*
+ * Returns the depth of the type, or -1 if it is too deep (or was not defined with
+ * DEFINE_EXCEPTION_TYPE) to have a hierarchy.
+ */
+static int ExceptionType_get_depth(const ExceptionType *self) {
+	ExceptionTypeHierarchy *hierarchy = self->hierarchy;
+	if (!hierarchy)
+		return -1;
+	int ready = __atomic_load_n(&hierarchy->ready, __ATOMIC_ACQUIRE);
+	if (ready)
+		return ready > 0 ? ready - 1 : -1;
+
+	int depth = 0;
+	for (const ExceptionType *type = self; type->super && (type != type->super); type = type->super)
+		depth++;
+	if (depth >= EXCEPTIONAL_MAX_TYPE_DEPTH) {
+		__atomic_store_n(&hierarchy->ready, -1, __ATOMIC_RELEASE);
+		return -1;
+	}
+
+	// Racing threads write the same values, so whoever publishes first is fine
+	const ExceptionType *type = self;
+	for (int i = depth; i >= 0; i--, type = type->super)
+		__atomic_store_n(&hierarchy->ancestors[i], type, __ATOMIC_RELAXED);
+	__atomic_store_n(&hierarchy->ready, depth + 1, __ATOMIC_RELEASE);
+	return depth;
+}
+
 bool ExceptionType_is_a(const ExceptionType *self, const ExceptionType *type) {
+	if (self == type)
+		return true;
+
+	int depth = ExceptionType_get_depth(self);
+	int type_depth = depth >= 0 ? ExceptionType_get_depth(type) : -1;
+	if (type_depth >= 0)
+		return (type_depth <= depth) && (__atomic_load_n(&self->hierarchy->ancestors[type_depth], __ATOMIC_RELAXED) == type);
+
 	while (true) {
 		if (self == type)
 			return true;
@@ -1,5 +1,6 @@
 #include "exceptional.h"
 #include <stdlib.h>
+#include <string.h>
 
 // Literal bstring
 #define BL(m) (& (struct tagbstring) bsStatic(m))
@@ -22,54 +23,34 @@ char *exceptional_bstring_to_string(bstring string_b) {
 }
 
 char *exceptional_strdup(const char *string) {
-	bstring dup_b = bfromcstr(string);
-	char *dup = exceptional_bstring_to_string(dup_b);
-	bdestroy(dup_b);
+	if (!string)
+		return NULL;
+	size_t size = strlen(string) + 1;
+	char *dup = malloc(size);
+	memcpy(dup, string, size);
 	return dup;
 }
 
 char *exceptional_sprintf(size_t max_size, const char *format, va_list args) {
-	char *string;
-	bstring string_b = bfromcstr("");
-	int r = bvcformata(string_b, max_size, format, args);
-	if (r > BSTR_ERR)
-		string = exceptional_bstring_to_string(string_b);
-	else
-		string = exceptional_strdup(format);
-	bdestroy(string_b);
-	return string;
-}
-
-char *exceptional_escape_spaces(const char *string) {
-	bstring SPACE = BL(" ");
-	bstring ESCAPED_SPACE = BL("\\ ");
+	if (!format)
+		return NULL;
 
-	bstring string_b = bfromcstr(string);
-	bfindreplace(string_b, SPACE, ESCAPED_SPACE, 0);
-	char *escaped = exceptional_bstring_to_string(string_b);
-	bdestroy(string_b);
-	return escaped;
-}
+	va_list args_copy;
+	va_copy(args_copy, args);
 
-bool exceptional_list_initialized(list_t *list) {
-	return list && list->head_sentinel;
-}
-
-void exceptional_list_move(list_t *source, list_t *destination) {
-	// Move all exceptions from our context to the relay context
-	exceptional_list_for_each (source, void, element)
-		list_append(destination, element);
-	list_clear(source);
-}
-
-bool exceptional_list_destroy_with_elements(list_t *list, exceptional_list_destroy_element_fn destroy_element) {
-	if (exceptional_list_initialized(list)) {
-		exceptional_list_for_each (list, void, element) {
-			if (destroy_element)
-				destroy_element(element);
-			free(element);
-		}
-		return true;
+	// Measure first, so that we allocate exactly once
+	int length = vsnprintf(NULL, 0, format, args);
+	char *string;
+	if (length < 0)
+		string = exceptional_strdup(format);
+	else {
+		size_t size = (size_t) length + 1;
+		if (size > max_size)
+			size = max_size;
+		string = malloc(size);
+		vsnprintf(string, size, format, args_copy);
 	}
-	return false;
+
+	va_end(args_copy);
+	return string;
 }